@@ -0,0 +1,169 @@
+// Moteur de couverture exacte (DancingLinks) contre le backtracking de
+// SearchEngine (solve(), ligne par ligne) : médiane de plusieurs exécutions
+// de la recherche complète (toutes les solutions), ou de la recherche de la
+// première avec --first, sur chaque fichier donné. La version parallèle
+// découpe le travail selon les options de la première case couverte, une
+// tâche par option dans un ThreadPool de --threads threads (par défaut, les
+// threads matériels). La construction de la matrice est comptée dans le temps
+// du moteur de couverture exacte.
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <thread>
+
+#include "../commun/macmahon.h"
+#include "../commun/index.h"
+#include "../commun/loader.h"
+#include "../commun/search.h"
+#include "../commun/dlx.h"
+#include "../commun/cancel.h"
+#include "../commun/threadpool.h"
+
+struct Measure {
+    double seconds;
+    long long nodes;
+    long long solutions;
+};
+
+struct Puzzle {
+    int rows, cols;
+    std::vector<MacMahonTile> tiles;
+    const CompatibilityIndex* index;
+};
+
+// Backtracking : une recherche par tuile posée en (0,0), comme le solveur séquentiel.
+static void runSearch(const Puzzle& p, bool first, Measure& m) {
+    SearchEngine engine(p.rows, p.cols, p.tiles, *p.index);
+    m.solutions = 0;
+    for (int i = 0; i < int(p.tiles.size()); ++i) {
+        engine.reset();
+        if (!engine.place(i)) {
+            continue;
+        }
+        if (first) {
+            if (engine.solve()) {
+                m.solutions = 1;
+                break;
+            }
+        } else {
+            m.solutions += engine.countSolutions();
+        }
+    }
+    m.nodes = engine.getNodes();
+}
+
+static void runDancingLinks(const Puzzle& p, bool first, Measure& m) {
+    DancingLinks dlx(p.rows, p.cols, p.tiles, *p.index);
+    m.solutions = first ? (dlx.solve() ? 1 : 0) : dlx.countSolutions();
+    m.nodes = dlx.getNodes();
+}
+
+// État partagé par les tâches d'une recherche parallèle (une seule capture,
+// pour tenir dans une case du pool).
+struct ParallelRun {
+    const Puzzle* puzzle;
+    bool first;
+    std::vector<int> choices;
+    std::atomic<long long> nodes;
+    std::atomic<long long> solutions;
+    CancellationToken cancellation;
+
+    ParallelRun(const Puzzle& p, bool first)
+        : puzzle(&p), first(first), choices(DancingLinks(p.rows, p.cols, p.tiles, *p.index).firstChoices()),
+          nodes(0), solutions(0) {}
+
+    void task(int i) {
+        const Puzzle& p = *puzzle;
+        DancingLinks dlx(p.rows, p.cols, p.tiles, *p.index);
+        if (!dlx.place(choices[i])) {
+            return;
+        }
+        if (first) {
+            if (dlx.solve(&cancellation) && solutions.exchange(1) == 0) {
+                cancellation.cancel();
+            }
+        } else {
+            solutions += dlx.countSolutions();
+        }
+        nodes += dlx.getNodes() + 1;
+    }
+};
+
+// Une tâche par option de la première case, arrêt de toutes à la première
+// solution trouvée avec --first.
+static void runParallel(const Puzzle& p, bool first, ThreadPool& pool, Measure& m) {
+    ParallelRun run(p, first);
+    pool.enqueueBulk(int(run.choices.size()), [&run](int i) { run.task(i); }, &run.cancellation);
+    pool.wait();
+    m.nodes = run.nodes;
+    m.solutions = run.solutions;
+}
+
+// Médiane des temps de repeats exécutions de run.
+template<class Run>
+static Measure median(int repeats, Run run) {
+    std::vector<double> times;
+    Measure m = {0, 0, 0};
+    for (int r = 0; r < repeats; ++r) {
+        auto start = std::chrono::high_resolution_clock::now();
+        run(m);
+        std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+        times.push_back(elapsed.count());
+    }
+    std::sort(times.begin(), times.end());
+    m.seconds = times[times.size() / 2];
+    return m;
+}
+
+int main(int argc, char* argv[]) {
+    int repeats = 5;
+    int threads = int(std::thread::hardware_concurrency());
+    bool first = false;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--repeats" && i + 1 < argc) {
+            repeats = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--first") {
+            first = true;
+        } else {
+            files.push_back(arg);
+        }
+    }
+    if (files.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [--first] [--repeats N] [--threads N] <filename>..." << std::endl;
+        return 1;
+    }
+
+    ThreadPool pool(threads);
+    for (const std::string& filename : files) {
+        Puzzle p;
+        LoadResult loaded = loadPuzzle(filename, p.rows, p.cols, p.tiles);
+        if (!loaded.ok()) {
+            std::cerr << describeLoadError(filename, loaded) << std::endl;
+            continue;
+        }
+        CompatibilityIndex index(p.tiles);
+        p.index = &index;
+
+        Measure search = median(repeats, [&](Measure& m) { runSearch(p, first, m); });
+        Measure dlx = median(repeats, [&](Measure& m) { runDancingLinks(p, first, m); });
+        Measure parallel = median(repeats, [&](Measure& m) { runParallel(p, first, pool, m); });
+        std::cout << filename << " (" << p.rows << "x" << p.cols << "), " << search.solutions
+                  << (first ? " solution trouvée" : " solutions") << std::endl;
+        std::cout << "  solve() : " << search.seconds << " s, " << search.nodes << " noeuds" << std::endl;
+        std::cout << "  dlx : " << dlx.seconds << " s, " << dlx.nodes << " noeuds, accélération x"
+                  << search.seconds / dlx.seconds << (dlx.solutions == search.solutions ? "" : " (RÉSULTATS DIFFÉRENTS)")
+                  << std::endl;
+        std::cout << "  dlx parallèle (" << threads << " threads) : " << parallel.seconds << " s, " << parallel.nodes
+                  << " noeuds, accélération x" << search.seconds / parallel.seconds
+                  << (parallel.solutions == search.solutions ? "" : " (RÉSULTATS DIFFÉRENTS)") << std::endl;
+    }
+    return 0;
+}
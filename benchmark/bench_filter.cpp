@@ -0,0 +1,150 @@
+// Coût par noeud du filtrage des tuiles candidates : l'ancienne boucle
+// canPlaceTile tuile par tuile, le filtre TileFilter (scalaire et vectoriel)
+// et la table CompatibilityIndex, sur des cases tirées au hasard d'un plateau
+// rempli avec les tuiles du fichier. Les quatre méthodes doivent donner le
+// même ensemble de candidates à chaque noeud.
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <cstdlib>
+
+#include "../commun/macmahon.h"
+#include "../commun/index.h"
+#include "../commun/loader.h"
+#include "../commun/filter.h"
+
+// Une case à remplir : plateau dont les voisins du dessus et de gauche sont
+// posés, et tuiles encore disponibles.
+struct Node {
+    int board;
+    int row, col;
+    TileSet remaining;
+};
+
+template<class Filter>
+static double measure(const char* name, const std::vector<Node>& nodes, int rounds, Filter filter,
+                      long long& checksum) {
+    auto start = std::chrono::high_resolution_clock::now();
+    long long sum = 0;
+    for (int r = 0; r < rounds; ++r) {
+        for (const Node& node : nodes) {
+            sum += filter(node).count();
+        }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+    double perNode = elapsed.count() * 1e9 / (double(nodes.size()) * rounds);
+    std::cout << "  " << name << "\t: " << perNode << " ns/noeud" << std::endl;
+    checksum = sum;
+    return perNode;
+}
+
+int main(int argc, char* argv[]) {
+    int samples = 4096;
+    int rounds = 200;
+    std::string filename;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--rounds" && i + 1 < argc) {
+            rounds = std::max(1, std::atoi(argv[++i]));
+        } else {
+            filename = arg;
+        }
+    }
+    if (filename.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [--rounds N] <filename>" << std::endl;
+        return 1;
+    }
+
+    int rows = 0, cols = 0;
+    std::vector<MacMahonTile> tiles;
+    LoadResult loaded = loadPuzzle(filename, rows, cols, tiles);
+    if (!loaded.ok()) {
+        std::cerr << describeLoadError(filename, loaded) << std::endl;
+        return 1;
+    }
+    int tileCount = std::min(int(tiles.size()), TileSet::CAPACITY);
+    CompatibilityIndex index(tiles);
+    TileFilter filter(tiles);
+
+    // Plateaux remplis d'une permutation aléatoire des tuiles, cases et tuiles
+    // restantes tirées au hasard
+    std::mt19937 rng(12345);
+    std::vector<MacMahonBoard> boards;
+    for (int b = 0; b < 64; ++b) {
+        std::vector<int> order(tiles.size());
+        for (int i = 0; i < int(order.size()); ++i) {
+            order[i] = i;
+        }
+        std::shuffle(order.begin(), order.end(), rng);
+        MacMahonBoard board(rows, cols);
+        for (int cell = 0; cell < rows * cols && cell < int(order.size()); ++cell) {
+            board.placeTile(cell / cols, cell % cols, tiles[order[cell]]);
+        }
+        boards.push_back(board);
+    }
+    std::vector<Node> nodes(samples);
+    for (Node& node : nodes) {
+        node.board = int(rng() % boards.size());
+        int cell = int(rng() % (rows * cols));
+        node.row = cell / cols;
+        node.col = cell % cols;
+        // Autant de tuiles restantes que de cases encore vides
+        std::vector<int> order(tileCount);
+        for (int i = 0; i < tileCount; ++i) {
+            order[i] = i;
+        }
+        std::shuffle(order.begin(), order.end(), rng);
+        for (int i = 0; i < tileCount - cell; ++i) {
+            node.remaining.set(order[i]);
+        }
+    }
+
+    auto loop = [&](const Node& node) {
+        const MacMahonBoard& board = boards[node.board];
+        TileSet result;
+        TileSet pending = node.remaining;
+        while (!pending.empty()) {
+            int i = pending.popFirst();
+            if (canPlaceTile(board, node.row, node.col, tiles[i])) {
+                result.set(i);
+            }
+        }
+        return result;
+    };
+    auto scalar = [&](const Node& node) {
+        return filter.matchingScalar(cellConstraint(boards[node.board], node.row, node.col)) & node.remaining;
+    };
+    auto simd = [&](const Node& node) {
+        return filter.matching(cellConstraint(boards[node.board], node.row, node.col)) & node.remaining;
+    };
+    auto table = [&](const Node& node) {
+        return index.candidates(cellConstraint(boards[node.board], node.row, node.col)) & node.remaining;
+    };
+
+    for (const Node& node : nodes) {
+        TileSet expected = loop(node);
+        if (!(scalar(node) == expected) || !(simd(node) == expected) || !(table(node) == expected)) {
+            std::cerr << "Résultats différents en (" << node.row << "," << node.col << ")" << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << filename << " (" << rows << "x" << cols << "), " << samples << " noeuds x " << rounds
+              << ", filtre " << TileFilter::implementation() << std::endl;
+    long long c1, c2, c3, c4;
+    double base = measure("canPlaceTile", nodes, rounds, loop, c1);
+    double s = measure("scalaire", nodes, rounds, scalar, c2);
+    // Sans jeu d'instructions vectoriel, matching() est le chemin scalaire
+    double v = s;
+    c3 = c2;
+    if (std::string(TileFilter::implementation()) != "scalaire") {
+        v = measure(TileFilter::implementation(), nodes, rounds, simd, c3);
+    }
+    double t = measure("index", nodes, rounds, table, c4);
+    std::cout << "  accélération sur canPlaceTile : scalaire x" << base / s << ", "
+              << TileFilter::implementation() << " x" << base / v << ", index x" << base / t << std::endl;
+    return c1 == c2 && c2 == c3 && c3 == c4 ? 0 : 1;
+}
@@ -0,0 +1,104 @@
+// Moteur spécialisé à la compilation (BasicSearchEngine<R, C>, plateaux
+// carrés de 3x3 à 8x8) contre le moteur générique SearchEngine, ligne par
+// ligne : médiane de plusieurs exécutions de la recherche complète (toutes
+// les solutions), ou de la recherche de la première avec --first, sur chaque
+// fichier donné.
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <algorithm>
+#include <cstdlib>
+
+#include "../commun/macmahon.h"
+#include "../commun/index.h"
+#include "../commun/loader.h"
+#include "../commun/search.h"
+#include "../commun/dispatch.h"
+
+struct Measure {
+    double seconds;
+    long long nodes;
+    long long solutions;
+};
+
+// Énumère toutes les solutions (ou cherche la première) avec le moteur de
+// taille R x C et garde la médiane des temps.
+template<int R, int C>
+struct CountKernel {
+    static void run(int rows, int cols, const std::vector<MacMahonTile>& tiles, const CompatibilityIndex& index,
+                    bool first, int repeats, Measure& result) {
+        std::vector<double> times;
+        for (int r = 0; r < repeats; ++r) {
+            BasicSearchEngine<R, C> engine(rows, cols, tiles, index);
+            auto start = std::chrono::high_resolution_clock::now();
+            long long solutions = 0;
+            for (int i = 0; i < int(tiles.size()); ++i) {
+                engine.reset();
+                if (!engine.place(i)) {
+                    continue;
+                }
+                if (first) {
+                    if (engine.solve()) {
+                        solutions = 1;
+                        break;
+                    }
+                } else {
+                    solutions += engine.countSolutions();
+                }
+            }
+            std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+            times.push_back(elapsed.count());
+            result.nodes = engine.getNodes();
+            result.solutions = solutions;
+        }
+        std::sort(times.begin(), times.end());
+        result.seconds = times[times.size() / 2];
+    }
+};
+
+int main(int argc, char* argv[]) {
+    int repeats = 5;
+    bool first = false;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--repeats" && i + 1 < argc) {
+            repeats = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--first") {
+            first = true;
+        } else {
+            files.push_back(arg);
+        }
+    }
+    if (files.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [--first] [--repeats N] <filename>..." << std::endl;
+        return 1;
+    }
+
+    for (const std::string& filename : files) {
+        int rows = 0, cols = 0;
+        std::vector<MacMahonTile> tiles;
+        LoadResult loaded = loadPuzzle(filename, rows, cols, tiles);
+        if (!loaded.ok()) {
+            std::cerr << describeLoadError(filename, loaded) << std::endl;
+            continue;
+        }
+        CompatibilityIndex index(tiles);
+
+        Measure generic, fixed;
+        CountKernel<0, 0>::run(rows, cols, tiles, index, first, repeats, generic);
+        bool specialized = dispatchBoardSize<CountKernel>(rows, cols, rows, cols, tiles, index, first, repeats, fixed);
+        std::cout << filename << " (" << rows << "x" << cols << "), " << generic.solutions << (first ? " solution trouvée, " : " solutions, ")
+                  << generic.nodes << " noeuds" << std::endl;
+        std::cout << "  générique : " << generic.seconds << " s" << std::endl;
+        if (!specialized) {
+            std::cout << "  pas de moteur spécialisé pour cette taille" << std::endl;
+            continue;
+        }
+        std::cout << "  spécialisé : " << fixed.seconds << " s, accélération x" << generic.seconds / fixed.seconds
+                  << (fixed.nodes == generic.nodes && fixed.solutions == generic.solutions ? "" : " (RÉSULTATS DIFFÉRENTS)")
+                  << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,206 @@
+// Moteur par jointure de lignes (RowTables, RowJoinSearch) contre le
+// backtracking de SearchEngine (solve(), ligne par ligne) : médiane de
+// plusieurs exécutions de la recherche complète (toutes les solutions), ou de
+// la recherche de la première avec --first, sur chaque fichier donné. La
+// version parallèle énumère les demi-lignes dans un ThreadPool de --threads
+// threads (par défaut, les threads matériels), puis lance une tâche par tuile
+// posée en (0,0). La construction des tables est comptée dans le temps du
+// moteur, et son temps seul est affiché à part ; --states N borne le nombre
+// d'états de la partie du bas.
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <thread>
+
+#include "../commun/macmahon.h"
+#include "../commun/index.h"
+#include "../commun/loader.h"
+#include "../commun/search.h"
+#include "../commun/rowjoin.h"
+#include "../commun/cancel.h"
+#include "../commun/threadpool.h"
+
+struct Measure {
+    double seconds;
+    double build;
+    long long nodes;
+    long long solutions;
+};
+
+struct Puzzle {
+    int rows, cols;
+    std::vector<MacMahonTile> tiles;
+    const CompatibilityIndex* index;
+    int stateLimit;
+};
+
+static double since(std::chrono::high_resolution_clock::time_point start) {
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+    return elapsed.count();
+}
+
+// Backtracking : une recherche par tuile posée en (0,0), comme le solveur séquentiel.
+static void runSearch(const Puzzle& p, bool first, Measure& m) {
+    SearchEngine engine(p.rows, p.cols, p.tiles, *p.index);
+    m.solutions = 0;
+    for (int i = 0; i < int(p.tiles.size()); ++i) {
+        engine.reset();
+        if (!engine.place(i)) {
+            continue;
+        }
+        if (first) {
+            if (engine.solve()) {
+                m.solutions = 1;
+                break;
+            }
+        } else {
+            m.solutions += engine.countSolutions();
+        }
+    }
+    m.nodes = engine.getNodes();
+}
+
+static void runRowJoin(const Puzzle& p, bool first, Measure& m) {
+    auto start = std::chrono::high_resolution_clock::now();
+    RowTables tables(p.rows, p.cols, p.tiles, *p.index);
+    tables.setStateLimit(p.stateLimit);
+    for (int i = 0; i < tables.enumerationTasks(); ++i) {
+        tables.enumerate(i);
+    }
+    tables.build();
+    m.build = since(start);
+
+    RowJoinSearch search(tables);
+    m.solutions = 0;
+    for (int i = 0; i < int(p.tiles.size()); ++i) {
+        if (first) {
+            if (search.solveFrom(i)) {
+                m.solutions = 1;
+                break;
+            }
+        } else {
+            m.solutions += std::max(0LL, search.countFrom(i));
+        }
+    }
+    m.nodes = search.getNodes();
+}
+
+// État partagé par les tâches d'une recherche parallèle (une seule capture,
+// pour tenir dans une case du pool).
+struct ParallelRun {
+    const RowTables* tables;
+    bool first;
+    std::atomic<long long> nodes;
+    std::atomic<long long> solutions;
+    CancellationToken cancellation;
+
+    ParallelRun(const RowTables& tables, bool first) : tables(&tables), first(first), nodes(0), solutions(0) {}
+
+    void task(int startTile) {
+        RowJoinSearch search(*tables);
+        if (first) {
+            if (search.solveFrom(startTile, &cancellation) && solutions.exchange(1) == 0) {
+                cancellation.cancel();
+            }
+        } else {
+            solutions += std::max(0LL, search.countFrom(startTile));
+        }
+        nodes += search.getNodes();
+    }
+};
+
+// Demi-lignes énumérées par le pool, partie du bas construite par ce thread,
+// puis une tâche par tuile de départ, arrêt de toutes à la première solution
+// trouvée avec --first.
+static void runParallel(const Puzzle& p, bool first, ThreadPool& pool, Measure& m) {
+    auto start = std::chrono::high_resolution_clock::now();
+    RowTables tables(p.rows, p.cols, p.tiles, *p.index);
+    tables.setStateLimit(p.stateLimit);
+    pool.enqueueBulk(tables.enumerationTasks(), [&tables](int i) { tables.enumerate(i); });
+    pool.wait();
+    tables.build();
+    m.build = since(start);
+
+    ParallelRun run(tables, first);
+    pool.enqueueBulk(int(p.tiles.size()), [&run](int i) { run.task(i); }, &run.cancellation);
+    pool.wait();
+    m.nodes = run.nodes;
+    m.solutions = run.solutions;
+}
+
+// Médiane des temps de repeats exécutions de run.
+template<class Run>
+static Measure median(int repeats, Run run) {
+    std::vector<double> times;
+    Measure m = {0, 0, 0, 0};
+    for (int r = 0; r < repeats; ++r) {
+        auto start = std::chrono::high_resolution_clock::now();
+        run(m);
+        times.push_back(since(start));
+    }
+    std::sort(times.begin(), times.end());
+    m.seconds = times[times.size() / 2];
+    return m;
+}
+
+int main(int argc, char* argv[]) {
+    int repeats = 5;
+    int threads = int(std::thread::hardware_concurrency());
+    int stateLimit = RowTables::DEFAULT_STATE_LIMIT;
+    bool first = false;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--repeats" && i + 1 < argc) {
+            repeats = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--states" && i + 1 < argc) {
+            stateLimit = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--first") {
+            first = true;
+        } else {
+            files.push_back(arg);
+        }
+    }
+    if (files.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [--first] [--repeats N] [--threads N] [--states N] <filename>..." << std::endl;
+        return 1;
+    }
+
+    ThreadPool pool(threads);
+    for (const std::string& filename : files) {
+        Puzzle p;
+        LoadResult loaded = loadPuzzle(filename, p.rows, p.cols, p.tiles);
+        if (!loaded.ok()) {
+            std::cerr << describeLoadError(filename, loaded) << std::endl;
+            continue;
+        }
+        if (p.cols > RowTables::MAX_COLS) {
+            std::cerr << filename << " : " << RowTables::MAX_COLS << " colonnes au plus" << std::endl;
+            continue;
+        }
+        CompatibilityIndex index(p.tiles);
+        p.index = &index;
+        p.stateLimit = stateLimit;
+
+        Measure search = median(repeats, [&](Measure& m) { runSearch(p, first, m); });
+        Measure join = median(repeats, [&](Measure& m) { runRowJoin(p, first, m); });
+        Measure parallel = median(repeats, [&](Measure& m) { runParallel(p, first, pool, m); });
+        std::cout << filename << " (" << p.rows << "x" << p.cols << "), " << search.solutions
+                  << (first ? " solution trouvée" : " solutions") << std::endl;
+        std::cout << "  solve() : " << search.seconds << " s, " << search.nodes << " noeuds" << std::endl;
+        std::cout << "  jointure : " << join.seconds << " s dont " << join.build << " s de tables, " << join.nodes
+                  << " lignes, accélération x" << search.seconds / join.seconds
+                  << (join.solutions == search.solutions ? "" : " (RÉSULTATS DIFFÉRENTS)") << std::endl;
+        std::cout << "  jointure parallèle (" << threads << " threads) : " << parallel.seconds << " s dont "
+                  << parallel.build << " s de tables, " << parallel.nodes << " lignes, accélération x"
+                  << search.seconds / parallel.seconds
+                  << (parallel.solutions == search.solutions ? "" : " (RÉSULTATS DIFFÉRENTS)") << std::endl;
+    }
+    return 0;
+}
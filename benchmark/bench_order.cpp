@@ -0,0 +1,77 @@
+// Comparaison des ordres de remplissage des cases (ligne par ligne, spirale
+// depuis la bordure, MRV), sans puis avec vérification en avant, sur un même
+// plateau : nombre de noeuds et temps jusqu'à la première solution, ou pour
+// l'énumération complète avec --count.
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <string>
+
+#include "../commun/macmahon.h"
+#include "../commun/index.h"
+#include "../commun/loader.h"
+#include "../commun/search.h"
+#include "../commun/symmetry.h"
+
+int main(int argc, char* argv[]) {
+    bool count = false;
+    std::string filename;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--count") {
+            count = true;
+        } else {
+            filename = arg;
+        }
+    }
+    if (filename.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [--count] <filename>" << std::endl;
+        return 1;
+    }
+
+    int rows = 0, cols = 0;
+    std::vector<MacMahonTile> tiles;
+    LoadResult loaded = loadPuzzle(filename, rows, cols, tiles);
+    if (!loaded.ok()) {
+        std::cerr << describeLoadError(filename, loaded) << std::endl;
+        return 1;
+    }
+    CompatibilityIndex index(tiles);
+    SymmetryBreaker symmetry(rows, cols, tiles);
+
+    std::cout << filename << " (" << rows << "x" << cols << ")" << (count ? ", toutes les solutions" : "")
+              << std::endl;
+    for (int run = 0; run < 2 * (ORDER_MRV + 1); ++run) {
+        int o = run % (ORDER_MRV + 1);
+        bool forwardCheck = run > ORDER_MRV;
+        SearchEngine engine(rows, cols, tiles, index, CellOrder(o));
+        engine.setForwardChecking(forwardCheck);
+        auto start = std::chrono::high_resolution_clock::now();
+        long long solutions = 0;
+        if (count) {
+            std::vector<long long> perFirstTile(tiles.size(), -1);
+            for (int i = 0; i < int(tiles.size()); ++i) {
+                engine.reset();
+                if (symmetry.isCanonicalStart(i) && engine.place(i)) {
+                    perFirstTile[i] = engine.countSolutions();
+                }
+            }
+            symmetry.completeSubtreeCounts(perFirstTile);
+            for (long long c : perFirstTile) {
+                solutions += c > 0 ? c : 0;
+            }
+        } else {
+            SearchTask root;
+            root.length = 0;
+            root.choices = symmetry.canonicalStarts();
+            engine.load(root);
+            solutions = engine.solve() ? 1 : 0;
+        }
+        std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+        std::cout << "  " << cellOrderName(CellOrder(o)) << (forwardCheck ? "+fc" : "") << "\t: " << engine.getNodes() << " noeuds, "
+                  << elapsed.count() << " s, " << engine.getNodes() / elapsed.count() << " noeuds/s"
+                  << (count ? ", solutions : " : ", solution : ") << solutions
+                  << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,419 @@
+// Banc d'essai de tous les solveurs : chaque exécutable est lancé comme un
+// utilisateur le lancerait, sur chaque plateau, avec quelques exécutions
+// d'échauffement puis des exécutions mesurées. Les solveurs affichent tous
+// le temps réel et le temps CPU de leur recherche et le nombre de noeuds
+// explorés (commun/timing.h) ; le banc en tire médiane et 95e centile, et
+// mesure aussi le temps total du processus (démarrage et chargement compris).
+// Les résultats sont écrits en texte, JSON ou CSV pour suivre les régressions
+// d'une version à l'autre.
+//   bench_solvers [--warmup N] [--repeats N] [--timeout S] [--format text|json|csv] [--output FICHIER]
+//                 [--label TEXTE] [--engine nom=exécutable]... [--arg OPTION]...
+//                 <fichier|répertoire|manifeste>...
+// Sans --engine, les exécutables du README présents dans le répertoire
+// courant sont utilisés. Chaque --arg est passé tel quel à tous les solveurs
+// (par exemple --arg --count).
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <poll.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../commun/batch.h"
+
+struct Engine {
+    std::string name;
+    std::string path;
+};
+
+// Une exécution d'un solveur sur un plateau.
+struct Run {
+    bool ok;                // terminé avec le code 0 et des statistiques lisibles
+    bool timedOut;
+    double wall;            // recherche, temps réel (affiché par le solveur)
+    double cpu;             // recherche, temps CPU (affiché par le solveur)
+    double process;         // processus entier, temps réel
+    double processCpu;      // processus entier, temps CPU (rusage)
+    long long nodes;
+    std::string result;     // nombre de solutions, "trouvée" ou "aucune"
+    std::string error;      // première ligne de la sortie si l'exécution a échoué
+};
+
+// Synthèse des exécutions mesurées d'un solveur sur un plateau.
+struct Summary {
+    std::string engine;
+    std::string file;
+    int runs;
+    int failures;
+    std::string result;     // "variable" si les exécutions ne s'accordent pas
+    double wallMedian, wallP95;
+    double cpuMedian, cpuP95;
+    double processMedian, processCpuMedian;
+    double nodesMedian;
+    double nodesPerSecond;
+    std::string error;
+};
+
+// Lance l'exécutable, récupère sa sortie (stdout et stderr) et ses temps ;
+// l'exécution est tuée au bout de timeout secondes (0 : sans limite).
+static Run runOnce(const Engine& engine, const std::vector<std::string>& args, const std::string& filename,
+                   double timeout) {
+    Run run = {false, false, 0, 0, 0, 0, 0, std::string(), std::string()};
+    int fds[2];
+    if (pipe(fds) != 0) {
+        run.error = "pipe impossible";
+        return run;
+    }
+    auto start = std::chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        run.error = "fork impossible";
+        return run;
+    }
+    if (pid == 0) {
+        dup2(fds[1], STDOUT_FILENO);
+        dup2(fds[1], STDERR_FILENO);
+        close(fds[0]);
+        close(fds[1]);
+        std::vector<char*> argv;
+        argv.push_back(const_cast<char*>(engine.path.c_str()));
+        for (const std::string& a : args) {
+            argv.push_back(const_cast<char*>(a.c_str()));
+        }
+        argv.push_back(const_cast<char*>(filename.c_str()));
+        argv.push_back(0);
+        execv(engine.path.c_str(), argv.data());
+        std::perror(engine.path.c_str());
+        _exit(127);
+    }
+    close(fds[1]);
+
+    std::string output;
+    char buffer[65536];
+    for (;;) {
+        int waitMs = -1;
+        if (timeout > 0) {
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            waitMs = int(std::max(0.0, (timeout - elapsed.count()) * 1000));
+        }
+        pollfd p = {fds[0], POLLIN, 0};
+        int ready = poll(&p, 1, waitMs);
+        if (ready == 0) {
+            kill(pid, SIGKILL);
+            run.timedOut = true;
+            break;
+        }
+        if (ready < 0) {
+            continue;
+        }
+        ssize_t got = read(fds[0], buffer, sizeof(buffer));
+        if (got <= 0) {
+            break;
+        }
+        output.append(buffer, size_t(got));
+    }
+    close(fds[0]);
+
+    int status = 0;
+    struct rusage usage;
+    wait4(pid, &status, 0, &usage);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    run.process = elapsed.count();
+    run.processCpu = double(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+                     double(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1e-6;
+    if (run.timedOut) {
+        run.error = "délai dépassé";
+        return run;
+    }
+
+    bool timed = false, counted = false;
+    std::istringstream lines(output);
+    std::string line;
+    while (std::getline(lines, line)) {
+        long long value = 0;
+        if (std::sscanf(line.c_str(), "Temps : %lf s (CPU : %lf s)", &run.wall, &run.cpu) == 2) {
+            timed = true;
+        } else if (std::sscanf(line.c_str(), "Noeuds explorés : %lld", &run.nodes) == 1) {
+            counted = true;
+        } else if (std::sscanf(line.c_str(), "Solutions : %lld", &value) == 1) {
+            run.result = std::to_string(value);
+        } else if (line.compare(0, 14, "Solution found") == 0 && run.result.empty()) {
+            run.result = "trouvée";
+        } else if (line.compare(0, 17, "No solution found") == 0 && run.result.empty()) {
+            run.result = "aucune";
+        }
+    }
+    run.ok = WIFEXITED(status) && WEXITSTATUS(status) == 0 && timed && counted;
+    if (!run.ok) {
+        std::string first = output.substr(0, output.find('\n'));
+        run.error = first.empty() ? "code de sortie " + std::to_string(WEXITSTATUS(status)) : first;
+    }
+    return run;
+}
+
+// Centile p (entre 0 et 1) par la méthode du rang le plus proche.
+static double percentile(std::vector<double> values, double p) {
+    if (values.empty()) {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    size_t rank = size_t(std::ceil(p * double(values.size())));
+    return values[rank > 0 ? rank - 1 : 0];
+}
+
+static double median(const std::vector<double>& values) {
+    if (values.empty()) {
+        return 0;
+    }
+    std::vector<double> sorted(values);
+    std::sort(sorted.begin(), sorted.end());
+    size_t n = sorted.size();
+    return n % 2 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2;
+}
+
+static Summary summarize(const Engine& engine, const std::string& filename, const std::vector<Run>& runs) {
+    Summary s;
+    s.engine = engine.name;
+    s.file = filename;
+    s.runs = 0;
+    s.failures = 0;
+    std::vector<double> wall, cpu, process, processCpu, nodes;
+    for (const Run& run : runs) {
+        if (!run.ok) {
+            ++s.failures;
+            s.error = run.error;
+            continue;
+        }
+        ++s.runs;
+        wall.push_back(run.wall);
+        cpu.push_back(run.cpu);
+        process.push_back(run.process);
+        processCpu.push_back(run.processCpu);
+        nodes.push_back(double(run.nodes));
+        if (s.runs == 1) {
+            s.result = run.result;
+        } else if (s.result != run.result) {
+            s.result = "variable";
+        }
+    }
+    s.wallMedian = median(wall);
+    s.wallP95 = percentile(wall, 0.95);
+    s.cpuMedian = median(cpu);
+    s.cpuP95 = percentile(cpu, 0.95);
+    s.processMedian = median(process);
+    s.processCpuMedian = median(processCpu);
+    s.nodesMedian = median(nodes);
+    s.nodesPerSecond = s.wallMedian > 0 ? s.nodesMedian / s.wallMedian : 0;
+    return s;
+}
+
+static std::string jsonString(const std::string& s) {
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (uint8_t(c) < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        } else {
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+static std::string csvField(const std::string& s) {
+    if (s.find_first_of(",\"\n") == std::string::npos) {
+        return s;
+    }
+    std::string out = "\"";
+    for (char c : s) {
+        out += c == '"' ? std::string("\"\"") : std::string(1, c);
+    }
+    return out + "\"";
+}
+
+static void writeJson(std::ostream& out, const std::string& label, int warmup, int repeats,
+                      const std::vector<std::string>& args, const std::vector<Summary>& summaries) {
+    out << "{\n  \"label\": " << jsonString(label) << ",\n"
+        << "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n"
+        << "  \"warmup\": " << warmup << ",\n  \"repeats\": " << repeats << ",\n  \"args\": [";
+    for (size_t i = 0; i < args.size(); ++i) {
+        out << (i ? ", " : "") << jsonString(args[i]);
+    }
+    out << "],\n  \"results\": [\n";
+    for (size_t i = 0; i < summaries.size(); ++i) {
+        const Summary& s = summaries[i];
+        out << "    {\"engine\": " << jsonString(s.engine) << ", \"file\": " << jsonString(s.file)
+            << ", \"runs\": " << s.runs << ", \"failures\": " << s.failures
+            << ", \"result\": " << jsonString(s.result)
+            << ", \"wall_median_s\": " << s.wallMedian << ", \"wall_p95_s\": " << s.wallP95
+            << ", \"cpu_median_s\": " << s.cpuMedian << ", \"cpu_p95_s\": " << s.cpuP95
+            << ", \"process_median_s\": " << s.processMedian << ", \"process_cpu_median_s\": " << s.processCpuMedian
+            << ", \"nodes\": " << s.nodesMedian << ", \"nodes_per_s\": " << s.nodesPerSecond
+            << ", \"error\": " << jsonString(s.error) << "}" << (i + 1 < summaries.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+static void writeCsv(std::ostream& out, const std::string& label, const std::vector<Summary>& summaries) {
+    out << "label,engine,file,runs,failures,result,wall_median_s,wall_p95_s,cpu_median_s,cpu_p95_s,"
+           "process_median_s,process_cpu_median_s,nodes,nodes_per_s,error\n";
+    for (const Summary& s : summaries) {
+        out << csvField(label) << "," << csvField(s.engine) << "," << csvField(s.file) << "," << s.runs << ","
+            << s.failures << "," << csvField(s.result) << "," << s.wallMedian << "," << s.wallP95 << ","
+            << s.cpuMedian << "," << s.cpuP95 << "," << s.processMedian << "," << s.processCpuMedian << ","
+            << s.nodesMedian << "," << s.nodesPerSecond << "," << csvField(s.error) << "\n";
+    }
+}
+
+static void writeText(std::ostream& out, const Summary& s) {
+    out << s.engine << " " << s.file << " : ";
+    if (s.runs == 0) {
+        out << "échec (" << s.error << ")" << std::endl;
+        return;
+    }
+    out << "résultat " << s.result << ", médiane " << s.wallMedian * 1000 << " ms (p95 " << s.wallP95 * 1000
+        << " ms), CPU " << s.cpuMedian * 1000 << " ms, processus " << s.processMedian * 1000 << " ms, "
+        << s.nodesMedian << " noeuds, " << s.nodesPerSecond << " noeuds/s";
+    if (s.failures > 0) {
+        out << ", " << s.failures << " échec(s) : " << s.error;
+    }
+    out << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    int warmup = 1, repeats = 5;
+    double timeout = 0;
+    std::string format = "text", outputFile, label;
+    std::vector<Engine> engines;
+    std::vector<std::string> args, sources;
+    bool valid = true;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--warmup" && i + 1 < argc) {
+            warmup = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--repeats" && i + 1 < argc) {
+            repeats = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--timeout" && i + 1 < argc) {
+            timeout = std::atof(argv[++i]);
+        } else if (arg == "--format" && i + 1 < argc) {
+            format = argv[++i];
+            valid = valid && (format == "text" || format == "json" || format == "csv");
+        } else if (arg == "--output" && i + 1 < argc) {
+            outputFile = argv[++i];
+        } else if (arg == "--label" && i + 1 < argc) {
+            label = argv[++i];
+        } else if (arg == "--engine" && i + 1 < argc) {
+            std::string spec = argv[++i];
+            size_t eq = spec.find('=');
+            valid = valid && eq != std::string::npos && eq > 0;
+            if (valid) {
+                engines.push_back(Engine{spec.substr(0, eq), spec.substr(eq + 1)});
+            }
+        } else if (arg == "--arg" && i + 1 < argc) {
+            args.push_back(argv[++i]);
+        } else if (arg.compare(0, 2, "--") == 0) {
+            valid = false;
+        } else {
+            sources.push_back(arg);
+        }
+    }
+    if (!valid || sources.empty() || (format == "text" && !outputFile.empty())) {
+        std::cerr << "Usage: " << argv[0] << " [--warmup N] [--repeats N] [--timeout S] [--format text|json|csv]"
+                  << " [--output FICHIER] [--label TEXTE] [--engine nom=exécutable]... [--arg OPTION]..."
+                  << " <fichier|répertoire|manifeste>..." << std::endl;
+        return 1;
+    }
+    if (engines.empty()) {
+        static const Engine defaults[] = {
+            {"sequentiel", "./main"}, {"thread", "./main_thread"}, {"threadpool", "./main_threadpool"},
+            {"workstealing", "./main_workstealing"}
+        };
+        for (const Engine& e : defaults) {
+            if (access(e.path.c_str(), X_OK) == 0) {
+                engines.push_back(e);
+            }
+        }
+        if (engines.empty()) {
+            std::cerr << "Aucun solveur compilé dans le répertoire courant : utiliser --engine" << std::endl;
+            return 1;
+        }
+    }
+
+    // Plateaux : un fichier .txt est pris tel quel, le reste est lu par PuzzleSource
+    std::vector<std::string> files;
+    for (const std::string& source : sources) {
+        if (source.size() > 4 && source.compare(source.size() - 4, 4, ".txt") == 0) {
+            files.push_back(source);
+            continue;
+        }
+        PuzzleSource list;
+        if (!list.open(source)) {
+            std::cerr << "Impossible d'ouvrir " << source << std::endl;
+            return 1;
+        }
+        std::string filename;
+        while (list.next(filename)) {
+            files.push_back(filename);
+        }
+    }
+
+    std::vector<Summary> summaries;
+    for (const std::string& filename : files) {
+        for (const Engine& engine : engines) {
+            std::vector<Run> runs;
+            bool timedOut = false;
+            for (int r = 0; r < warmup + repeats && !timedOut; ++r) {
+                Run run = runOnce(engine, args, filename, timeout);
+                // Un plateau trop long n'est pas relancé
+                timedOut = run.timedOut;
+                if (r >= warmup || timedOut) {
+                    runs.push_back(run);
+                }
+            }
+            summaries.push_back(summarize(engine, filename, runs));
+            // Progression : le texte sur la sortie standard, sinon sur la sortie d'erreur
+            writeText(format == "text" ? std::cout : std::cerr, summaries.back());
+        }
+    }
+
+    if (format != "text") {
+        std::ofstream file;
+        if (!outputFile.empty()) {
+            file.open(outputFile);
+            if (!file) {
+                std::cerr << "Impossible d'écrire " << outputFile << std::endl;
+                return 1;
+            }
+        }
+        std::ostream& out = outputFile.empty() ? std::cout : file;
+        if (format == "json") {
+            writeJson(out, label, warmup, repeats, args, summaries);
+        } else {
+            writeCsv(out, label, summaries);
+        }
+    }
+    int failed = 0;
+    for (const Summary& s : summaries) {
+        failed += s.runs == 0;
+    }
+    return failed ? 1 : 0;
+}
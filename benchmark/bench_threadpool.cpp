@@ -0,0 +1,138 @@
+// Micro-benchmark du débit de tâches : ancien ThreadPool (mutex +
+// condition_variable + std::function) contre le pool à file sans verrou de
+// commun/threadpool.h. Chaque tâche ne fait qu'incrémenter un compteur, si
+// bien que le temps mesuré est celui de la gestion des tâches.
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <queue>
+#include <functional>
+#include <future>
+#include <chrono>
+#include <string>
+
+#include "../commun/threadpool.h"
+
+// ThreadPool d'origine de version threadpool/main_threadpool.cpp, gardé tel quel pour la comparaison.
+class MutexThreadPool {
+public:
+    MutexThreadPool(size_t threads) : stop(false) {
+        for(size_t i = 0; i < threads; ++i)
+            workers.emplace_back(
+                [this] {
+                    for(;;) {
+                        std::function<void()> task;
+                        {
+                            std::unique_lock<std::mutex> lock(this->queue_mutex);
+                            this->condition.wait(lock,
+                                [this] { return this->stop || !this->tasks.empty(); });
+                            if(this->stop && this->tasks.empty())
+                                return;
+                            task = std::move(this->tasks.front());
+                            this->tasks.pop();
+                        }
+                        task();
+                    }
+                }
+            );
+    }
+
+    template<class F, class... Args>
+    auto enqueue(F&& f, Args&&... args) 
+        -> std::future<typename std::result_of<F(Args...)>::type> {
+        using return_type = typename std::result_of<F(Args...)>::type;
+        auto task = std::make_shared< std::packaged_task<return_type()> >(
+            std::bind(std::forward<F>(f), std::forward<Args>(args)...)
+        );        
+        std::future<return_type> res = task->get_future();
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            if(stop)
+                throw std::runtime_error("enqueue on stopped ThreadPool");
+            tasks.emplace([task](){ (*task)(); });
+        }
+        condition.notify_one();
+        return res;
+    }
+
+    ~MutexThreadPool() {
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            stop = true;
+        }
+        condition.notify_all();
+        for(std::thread &worker: workers)
+            worker.join();
+    }
+
+private:
+    std::vector< std::thread > workers;
+    std::queue< std::function<void()> > tasks;
+    
+    std::mutex queue_mutex;
+    std::condition_variable condition;
+    bool stop;
+};
+
+std::atomic<long long> counter(0);
+
+double benchMutexPool(size_t threads, int tasks) {
+    auto start = std::chrono::high_resolution_clock::now();
+    {
+        MutexThreadPool pool(threads);
+        std::vector<std::future<void>> futures;
+        futures.reserve(tasks);
+        for (int i = 0; i < tasks; ++i) {
+            futures.emplace_back(pool.enqueue([] { counter.fetch_add(1, std::memory_order_relaxed); }));
+        }
+        for (auto &f : futures) {
+            f.wait();
+        }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+    return elapsed.count();
+}
+
+double benchLockFreePool(size_t threads, int tasks) {
+    auto start = std::chrono::high_resolution_clock::now();
+    {
+        ThreadPool pool(threads);
+        for (int i = 0; i < tasks; ++i) {
+            pool.enqueue([] { counter.fetch_add(1, std::memory_order_relaxed); });
+        }
+        pool.wait();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+    return elapsed.count();
+}
+
+double benchLockFreeBulk(size_t threads, int tasks) {
+    auto start = std::chrono::high_resolution_clock::now();
+    {
+        ThreadPool pool(threads);
+        pool.enqueueBulk(tasks, [](int) { counter.fetch_add(1, std::memory_order_relaxed); });
+        pool.wait();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+    return elapsed.count();
+}
+
+int main(int argc, char* argv[]) {
+    int tasks = argc > 1 ? std::stoi(argv[1]) : 1000000;
+    size_t threads = argc > 2 ? std::stoul(argv[2]) : std::thread::hardware_concurrency();
+    if (threads == 0) {
+        threads = 1;
+    }
+
+    std::cout << "Tâches : " << tasks << ", threads : " << threads << std::endl;
+    double t = benchMutexPool(threads, tasks);
+    std::cout << "ThreadPool mutex        : " << t << " s, " << tasks / t << " tâches/s" << std::endl;
+    t = benchLockFreePool(threads, tasks);
+    std::cout << "ThreadPool sans verrou  : " << t << " s, " << tasks / t << " tâches/s" << std::endl;
+    t = benchLockFreeBulk(threads, tasks);
+    std::cout << "  ajout groupé          : " << t << " s, " << tasks / t << " tâches/s" << std::endl;
+    return counter.load() == 3LL * tasks ? 0 : 1;
+}
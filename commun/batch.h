@@ -0,0 +1,106 @@
+#ifndef MACMAHON_BATCH_H
+#define MACMAHON_BATCH_H
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+// Liste de fichiers de plateaux à résoudre en série :
+//   - un répertoire : tous ses fichiers *.txt, par ordre alphabétique ;
+//   - "-" : un chemin par ligne lu sur l'entrée standard, au fil de l'eau ;
+//   - tout autre fichier : un manifeste, un chemin par ligne (les chemins
+//     relatifs le sont au répertoire du manifeste).
+// Dans l'entrée standard et les manifestes, les lignes vides et celles qui
+// commencent par # sont ignorées.
+class PuzzleSource {
+public:
+    PuzzleSource() : position(0), input(0) {}
+
+    // Renvoie false si la source ne peut pas être ouverte.
+    bool open(const std::string& source) {
+        files.clear();
+        position = 0;
+        stream.reset();
+        input = 0;
+        baseDir.clear();
+        if (source == "-") {
+            input = &std::cin;
+            return true;
+        }
+        struct stat info;
+        if (stat(source.c_str(), &info) != 0) {
+            return false;
+        }
+        if (S_ISDIR(info.st_mode)) {
+            return listDirectory(source);
+        }
+        stream.reset(new std::ifstream(source));
+        if (!*stream) {
+            return false;
+        }
+        input = stream.get();
+        size_t slash = source.find_last_of('/');
+        if (slash != std::string::npos) {
+            baseDir = source.substr(0, slash + 1);
+        }
+        return true;
+    }
+
+    // Chemin du fichier suivant ; false quand la source est épuisée.
+    bool next(std::string& filename) {
+        if (!input) {
+            if (position >= files.size()) {
+                return false;
+            }
+            filename = files[position++];
+            return true;
+        }
+        std::string line;
+        while (std::getline(*input, line)) {
+            // Espaces de début et de fin (et \r des fichiers Windows)
+            size_t first = line.find_first_not_of(" \t\r");
+            if (first == std::string::npos || line[first] == '#') {
+                continue;
+            }
+            size_t last = line.find_last_not_of(" \t\r");
+            filename = line.substr(first, last - first + 1);
+            if (filename[0] != '/') {
+                filename = baseDir + filename;
+            }
+            return true;
+        }
+        return false;
+    }
+
+private:
+    bool listDirectory(const std::string& dir) {
+        DIR* d = opendir(dir.c_str());
+        if (!d) {
+            return false;
+        }
+        std::string prefix = dir.empty() || dir[dir.size() - 1] == '/' ? dir : dir + "/";
+        while (struct dirent* entry = readdir(d)) {
+            std::string name = entry->d_name;
+            if (name.size() > 4 && name.compare(name.size() - 4, 4, ".txt") == 0) {
+                files.push_back(prefix + name);
+            }
+        }
+        closedir(d);
+        std::sort(files.begin(), files.end());
+        return true;
+    }
+
+    std::vector<std::string> files;
+    size_t position;
+    std::unique_ptr<std::ifstream> stream;
+    std::istream* input;
+    std::string baseDir;
+};
+
+#endif
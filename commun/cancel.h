@@ -0,0 +1,37 @@
+#ifndef MACMAHON_CANCEL_H
+#define MACMAHON_CANCEL_H
+
+#include <atomic>
+#include <chrono>
+
+// Jeton d'annulation partagé entre les tâches d'une même recherche.
+// Le moteur le consulte tous les N noeuds et le pool jette sans les exécuter
+// les tâches en file dont le jeton est annulé.
+class CancellationToken {
+public:
+    CancellationToken() : cancelled(false) {}
+
+    // Annule le jeton ; renvoie true pour l'appel qui l'a effectivement annulé.
+    bool cancel() {
+        if (cancelled.exchange(true)) {
+            return false;
+        }
+        cancelTime = std::chrono::steady_clock::now();
+        return true;
+    }
+
+    bool isCancelled() const {
+        return cancelled.load(std::memory_order_relaxed);
+    }
+
+    // Instant de l'annulation, valable une fois les threads terminés.
+    std::chrono::steady_clock::time_point cancelledAt() const {
+        return cancelTime;
+    }
+
+private:
+    std::atomic_bool cancelled;
+    std::chrono::steady_clock::time_point cancelTime;
+};
+
+#endif
@@ -0,0 +1,258 @@
+#ifndef MACMAHON_CONTAINER_H
+#define MACMAHON_CONTAINER_H
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "macmahon.h"
+#include "index.h"
+#include "loader.h"
+
+// Conteneur binaire de plateaux ou de solutions, pour les grands corpus.
+// Entiers en petit-boutiste :
+//   en-tête (16 octets) : "MMHC", version (u16), type (u16), nombre
+//                         d'enregistrements N (u32), réservé (u32, 0)
+//   index               : N décalages (u64) depuis le début du fichier
+//   enregistrements     : à la suite, dans l'ordre de l'index
+// Plateau :  longueur du nom (u8), nom, ROWS (u8), COLS (u8), puis une tuile
+//            compactée par octet (2 bits par côté, comme MacMahonTile).
+// Solution : numéro du plateau dans son conteneur (u32), nombre de solutions
+//            (u64, 0 si aucune), plateau présent (u8), ROWS (u8), COLS (u8),
+//            puis, si le plateau est présent, ses ROWS * COLS tuiles ligne par
+//            ligne, un octet chacune.
+// Un plateau 6x6 tient ainsi en 39 octets plus son nom et son entrée d'index,
+// contre près de 300 au format texte, et l'index permet de lire le k-ième
+// sans parcourir les précédents.
+
+enum ContainerKind {
+    CONTAINER_PUZZLES = 1,
+    CONTAINER_SOLUTIONS = 2
+};
+
+static const uint16_t CONTAINER_VERSION = 1;
+
+struct PuzzleRecord {
+    std::string name;
+    int rows, cols;
+    std::vector<MacMahonTile> tiles;
+};
+
+struct SolutionRecord {
+    uint32_t puzzle;
+    uint64_t solutions;
+    int rows, cols;
+    std::vector<MacMahonTile> board;    // vide si aucune solution n'est gardée
+};
+
+// Construit un conteneur en mémoire puis l'écrit d'un bloc.
+class ContainerWriter {
+public:
+    explicit ContainerWriter(ContainerKind kind) : kind(kind) {}
+
+    void addPuzzle(const std::string& name, int rows, int cols, const std::vector<MacMahonTile>& tiles) {
+        offsets.push_back(records.size());
+        std::string shortName = name.substr(0, 255);
+        putByte(uint8_t(shortName.size()));
+        records += shortName;
+        putTiles(rows, cols, tiles);
+    }
+
+    void addSolution(const SolutionRecord& record) {
+        offsets.push_back(records.size());
+        putInt(record.puzzle, 4);
+        putInt(record.solutions, 8);
+        putByte(uint8_t(!record.board.empty()));
+        putTiles(record.rows, record.cols, record.board);
+    }
+
+    size_t size() const {
+        return offsets.size();
+    }
+
+    bool save(const std::string& filename) const {
+        std::string header("MMHC", 4);
+        appendInt(header, CONTAINER_VERSION, 2);
+        appendInt(header, uint16_t(kind), 2);
+        appendInt(header, offsets.size(), 4);
+        appendInt(header, 0, 4);
+        uint64_t base = header.size() + 8 * offsets.size();
+        for (uint64_t offset : offsets) {
+            appendInt(header, base + offset, 8);
+        }
+        std::ofstream out(filename, std::ios::binary);
+        out.write(header.data(), std::streamsize(header.size()));
+        out.write(records.data(), std::streamsize(records.size()));
+        return bool(out);
+    }
+
+private:
+    static void appendInt(std::string& s, uint64_t value, int bytes) {
+        for (int i = 0; i < bytes; ++i) {
+            s += char((value >> (8 * i)) & 0xff);
+        }
+    }
+
+    void putInt(uint64_t value, int bytes) {
+        appendInt(records, value, bytes);
+    }
+
+    void putByte(uint8_t value) {
+        records += char(value);
+    }
+
+    // Dimensions puis tuiles (aucune si le vecteur est vide)
+    void putTiles(int rows, int cols, const std::vector<MacMahonTile>& tiles) {
+        putByte(uint8_t(rows));
+        putByte(uint8_t(cols));
+        for (const MacMahonTile& tile : tiles) {
+            putByte(tile.getBits());
+        }
+    }
+
+    ContainerKind kind;
+    std::vector<uint64_t> offsets;
+    std::string records;
+};
+
+// Lecture d'un conteneur : l'en-tête et l'index sont vérifiés à l'ouverture,
+// chaque enregistrement l'est à sa lecture.
+class ContainerReader {
+public:
+    ContainerReader() : containerKind(CONTAINER_PUZZLES), count(0) {}
+
+    // Vrai si le fichier commence par la signature du conteneur.
+    static bool isContainer(const std::string& filename) {
+        std::ifstream in(filename, std::ios::binary);
+        char magic[4] = {};
+        return in.read(magic, 4) && std::memcmp(magic, "MMHC", 4) == 0;
+    }
+
+    LoadResult open(const std::string& filename) {
+        count = 0;
+        if (!file.open(filename)) {
+            return LoadResult{LOAD_CANNOT_OPEN, 0, "impossible d'ouvrir le fichier"};
+        }
+        if (file.size() < 16 || std::memcmp(file.data(), "MMHC", 4) != 0) {
+            return invalid("signature absente");
+        }
+        uint64_t version = readInt(4, 2), kind = readInt(6, 2), n = readInt(8, 4);
+        if (version != CONTAINER_VERSION) {
+            return invalid("version " + std::to_string(version) + " non supportée");
+        }
+        if (kind != CONTAINER_PUZZLES && kind != CONTAINER_SOLUTIONS) {
+            return invalid("type " + std::to_string(kind) + " inconnu");
+        }
+        if (16 + 8 * n > file.size()) {
+            return invalid("index tronqué");
+        }
+        containerKind = ContainerKind(kind);
+        count = size_t(n);
+        return LoadResult{LOAD_OK, 0, std::string()};
+    }
+
+    ContainerKind kind() const {
+        return containerKind;
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    // Lit le i-ième plateau ; mêmes vérifications que loadPuzzle.
+    LoadResult puzzle(size_t i, PuzzleRecord& record) const {
+        size_t p;
+        if (containerKind != CONTAINER_PUZZLES || !recordStart(i, p) || p + 1 > file.size()) {
+            return invalid("plateau " + std::to_string(i) + " absent");
+        }
+        size_t nameLength = uint8_t(file.data()[p++]);
+        if (p + nameLength > file.size()) {
+            return invalid("plateau " + std::to_string(i) + " tronqué");
+        }
+        record.name.assign(file.data() + p, nameLength);
+        p += nameLength;
+        LoadResult result = readTiles(i, p, true, record.rows, record.cols, record.tiles);
+        if (result.ok() && !borderSolvable(record.rows, record.cols, record.tiles)) {
+            return LoadResult{LOAD_UNSOLVABLE, 0, "aucune couleur de bordure possible : le jeu n'a pas de solution"};
+        }
+        return result;
+    }
+
+    LoadResult solution(size_t i, SolutionRecord& record) const {
+        size_t p;
+        if (containerKind != CONTAINER_SOLUTIONS || !recordStart(i, p) || p + 13 > file.size()) {
+            return invalid("solution " + std::to_string(i) + " absente");
+        }
+        record.puzzle = uint32_t(readInt(p, 4));
+        record.solutions = readInt(p + 4, 8);
+        bool hasBoard = file.data()[p + 12] != 0;
+        return readTiles(i, p + 13, hasBoard, record.rows, record.cols, record.board);
+    }
+
+private:
+    LoadResult invalid(const std::string& why) const {
+        return LoadResult{LOAD_BAD_CONTAINER, 0, "conteneur invalide : " + why};
+    }
+
+    uint64_t readInt(size_t at, int bytes) const {
+        uint64_t value = 0;
+        for (int k = 0; k < bytes; ++k) {
+            value |= uint64_t(uint8_t(file.data()[at + k])) << (8 * k);
+        }
+        return value;
+    }
+
+    bool recordStart(size_t i, size_t& p) const {
+        if (i >= count) {
+            return false;
+        }
+        p = size_t(readInt(16 + 8 * i, 8));
+        return p < file.size();
+    }
+
+    LoadResult readTiles(size_t i, size_t p, bool withTiles, int& rows, int& cols,
+                         std::vector<MacMahonTile>& tiles) const {
+        tiles.clear();
+        if (p + 2 > file.size()) {
+            return invalid("enregistrement " + std::to_string(i) + " tronqué");
+        }
+        rows = uint8_t(file.data()[p]);
+        cols = uint8_t(file.data()[p + 1]);
+        p += 2;
+        if (rows == 0 || cols == 0 || rows * cols > MAX_BOARD_CELLS) {
+            return invalid("dimensions " + std::to_string(rows) + "x" + std::to_string(cols) +
+                           " de l'enregistrement " + std::to_string(i));
+        }
+        if (!withTiles) {
+            return LoadResult{LOAD_OK, 0, std::string()};
+        }
+        size_t cells = size_t(rows * cols);
+        if (p + cells > file.size()) {
+            return invalid("enregistrement " + std::to_string(i) + " tronqué");
+        }
+        tiles.resize(cells);
+        for (size_t k = 0; k < cells; ++k) {
+            uint8_t bits = uint8_t(file.data()[p + k]);
+            MacMahonTile tile;
+            tile.setColors(TileColor(bits & 3), TileColor((bits >> 2) & 3), TileColor((bits >> 4) & 3),
+                           TileColor(bits >> 6));
+            // Aucun côté vide : même règle que les lettres R, G, B du format texte
+            for (int side = LEFT; side <= BOTTOM; ++side) {
+                if (tile.getColorAt(side) == EMPTY) {
+                    return LoadResult{LOAD_BAD_COLOR, 0, "côté vide dans la tuile " + std::to_string(k) +
+                                                             " de l'enregistrement " + std::to_string(i)};
+                }
+            }
+            tiles[k] = tile;
+        }
+        return LoadResult{LOAD_OK, 0, std::string()};
+    }
+
+    MappedFile file;
+    ContainerKind containerKind;
+    size_t count;
+};
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef MACMAHON_DISPATCH_H
+#define MACMAHON_DISPATCH_H
+
+#include <utility>
+
+// Choix à l'exécution d'un noyau spécialisé à la compilation.
+// Kernel<R, C>::run(args...) est appelé avec la taille du plateau lue dans le
+// fichier pour les plateaux carrés de 3x3 à 8x8, Kernel<0, 0>::run(args...)
+// (taille lue à l'exécution) pour toutes les autres. Renvoie true si un noyau
+// spécialisé a été utilisé.
+template<template<int, int> class Kernel, class... Args>
+bool dispatchBoardSize(int rows, int cols, Args&&... args) {
+    if (rows == cols) {
+        switch (rows) {
+            case 3:
+                Kernel<3, 3>::run(std::forward<Args>(args)...);
+                return true;
+            case 4:
+                Kernel<4, 4>::run(std::forward<Args>(args)...);
+                return true;
+            case 5:
+                Kernel<5, 5>::run(std::forward<Args>(args)...);
+                return true;
+            case 6:
+                Kernel<6, 6>::run(std::forward<Args>(args)...);
+                return true;
+            case 7:
+                Kernel<7, 7>::run(std::forward<Args>(args)...);
+                return true;
+            case 8:
+                Kernel<8, 8>::run(std::forward<Args>(args)...);
+                return true;
+        }
+    }
+    Kernel<0, 0>::run(std::forward<Args>(args)...);
+    return false;
+}
+
+#endif
@@ -0,0 +1,484 @@
+#ifndef MACMAHON_DLX_H
+#define MACMAHON_DLX_H
+
+#include <algorithm>
+#include <vector>
+
+#include "macmahon.h"
+#include "index.h"
+#include "cancel.h"
+#include "search.h"
+
+// Moteur de couverture exacte, à la place de BasicSearchEngine (option --dlx).
+// Le jeu est posé comme un problème de couverture exacte avec couleurs
+// (algorithme C de Knuth, liens dansants) :
+//   - éléments primaires : les cases, chacune couverte une fois ;
+//   - éléments secondaires sans couleur : les tuiles, posées au plus une fois
+//     (il y a autant de cases que de tuiles, donc chacune l'est exactement) ;
+//   - éléments secondaires colorés : chaque côté commun à deux cases voisines,
+//     qui prend la couleur des deux tuiles, et les trois bordures du plateau
+//     (gauche et haut, droite, bas), qui prennent celle des côtés extérieurs.
+// Une option par couple (case, tuile), ou (case, orientation) en mode
+// --rotations. Choisir une option retire toutes celles qui donnent une autre
+// couleur à l'un de ses éléments colorés. À chaque étape, la case couverte est
+// celle qui a le moins d'options restantes : l'ordre des cases n'est pas fixé.
+// Comme dans BasicSearchEngine, une tuile n'est posée que si ses copies
+// identiques précédentes le sont déjà : chaque solution est rendue une fois.
+// Tout est alloué à la construction ; la recherche n'alloue rien.
+class DancingLinks {
+public:
+    // Nombre de noeuds entre deux lectures du jeton d'annulation.
+    static const int DEFAULT_CHECK_INTERVAL = 1024;
+
+    DancingLinks(int rows, int cols, const std::vector<MacMahonTile>& tiles, const CompatibilityIndex& index)
+        : board(rows, cols), tiles(tiles), cellCount(rows * cols), nodes(0),
+          checkInterval(DEFAULT_CHECK_INTERVAL) {
+        int pieces = 0;
+        for (int k = 0; k < int(tiles.size()); ++k) {
+            pieces = std::max(pieces, index.pieceOf(k) + 1);
+        }
+        // Copie précédente de chaque tuile : la plus proche qui partage ses orientations
+        previousCopy.assign(pieces, -1);
+        firstOfType.resize(tiles.size());
+        for (int k = 0; k < int(tiles.size()); ++k) {
+            firstOfType[k] = k;
+            for (int j = k - 1; j >= 0; --j) {
+                if (tiles[j].getBits() != tiles[k].getBits()) {
+                    continue;
+                }
+                firstOfType[k] = j;
+                int& previous = previousCopy[index.pieceOf(k)];
+                previous = std::max(previous, index.pieceOf(j));
+            }
+        }
+        used.assign(pieces, false);
+
+        // Éléments : cases, tuiles, bordures, côtés communs horizontaux puis verticaux
+        int tileItems = cellCount + 1;
+        int borderItems = tileItems + pieces;
+        int rowEdges = borderItems + 3;
+        int colEdges = rowEdges + rows * (cols - 1);
+        itemCount = colEdges + (rows - 1) * cols - 1;
+        llink.resize(itemCount + 2);
+        rlink.resize(itemCount + 2);
+        // Deux listes circulaires : primaires sous la tête 0, secondaires sous itemCount + 1
+        int secondaryHead = itemCount + 1;
+        for (int i = 0; i <= itemCount + 1; ++i) {
+            llink[i] = i - 1;
+            rlink[i] = i + 1;
+        }
+        llink[0] = cellCount;
+        rlink[cellCount] = 0;
+        llink[tileItems] = secondaryHead;
+        rlink[secondaryHead] = tileItems;
+        llink[secondaryHead] = itemCount;
+        rlink[itemCount] = secondaryHead;
+        for (int i = 0; i <= itemCount; ++i) {
+            newNode(i, 0);
+            ulink[i] = dlink[i] = i;
+        }
+        len.assign(itemCount + 1, 0);
+        int spacer = newNode(0, 0);
+
+        for (int cell = 0; cell < cellCount; ++cell) {
+            int row = cell / cols, col = cell % cols;
+            for (int k = 0; k < int(tiles.size()); ++k) {
+                const MacMahonTile& t = tiles[k];
+                // Le coin porte les deux couleurs de la bordure gauche et haute
+                if (cell == 0 && t.getColorAt(LEFT) != t.getColorAt(TOP)) {
+                    continue;
+                }
+                int first = int(top.size());
+                addToItem(cell + 1, 0);
+                addToItem(tileItems + index.pieceOf(k), 0);
+                if (col == 0 || row == 0) {
+                    addToItem(borderItems, t.getColorAt(col == 0 ? LEFT : TOP));
+                }
+                if (col == cols - 1) {
+                    addToItem(borderItems + 1, t.getColorAt(RIGHT));
+                }
+                if (row == rows - 1) {
+                    addToItem(borderItems + 2, t.getColorAt(BOTTOM));
+                }
+                if (col > 0) {
+                    addToItem(rowEdges + row * (cols - 1) + col - 1, t.getColorAt(LEFT));
+                }
+                if (col < cols - 1) {
+                    addToItem(rowEdges + row * (cols - 1) + col, t.getColorAt(RIGHT));
+                }
+                if (row > 0) {
+                    addToItem(colEdges + (row - 1) * cols + col, t.getColorAt(TOP));
+                }
+                if (row < rows - 1) {
+                    addToItem(colEdges + row * cols + col, t.getColorAt(BOTTOM));
+                }
+                // Intercalaire : premier noeud de l'option précédente, dernier de la suivante
+                int option = int(optionCell.size());
+                optionCell.push_back(cell);
+                optionTile.push_back(k);
+                optionPiece.push_back(index.pieceOf(k));
+                for (int x = first; x < int(top.size()); ++x) {
+                    optionOf[x] = option;
+                }
+                dlink[spacer] = int(top.size()) - 1;
+                spacer = newNode(-(option + 1), 0);
+                ulink[spacer] = first;
+            }
+        }
+        chosen.resize(cellCount + 1);
+        choice.resize(cellCount + 1);
+    }
+
+    void setCheckInterval(int interval) {
+        checkInterval = interval < 1 ? 1 : interval;
+    }
+
+    // Vide le plateau ; le compteur de noeuds est conservé.
+    void reset() {
+        while (level > 0) {
+            --level;
+            retract(choice[level]);
+            uncover(chosen[level]);
+        }
+        base = 0;
+        resume = ENTER;
+    }
+
+    // Comptes par tuile posée en (0,0) avant la recherche : 0, ou -1 pour
+    // les tuiles qui ne peuvent pas y être posées.
+    std::vector<long long> startCounts() const {
+        std::vector<long long> counts(tiles.size(), -1);
+        for (int option = 0; option < int(optionCell.size()) && optionCell[option] == 0; ++option) {
+            counts[optionTile[option]] = 0;
+        }
+        return counts;
+    }
+
+    // Premier découpage pour les versions parallèles : options de la case
+    // que la recherche couvrirait d'abord (celle qui en a le moins).
+    std::vector<int> firstChoices() const {
+        std::vector<int> options;
+        int item = mostConstrainedItem();
+        for (int x = dlink[item]; x != item; x = dlink[x]) {
+            options.push_back(optionOf[x]);
+        }
+        return options;
+    }
+
+    // Sur le plateau vide, pose l'option et la fixe comme préfixe que run()
+    // ne remet jamais en cause. Renvoie false si c'est une copie qui ne peut
+    // pas encore être posée.
+    bool place(int option) {
+        int piece = optionPiece[option];
+        if (level != 0 || (previousCopy[piece] >= 0 && !used[previousCopy[piece]])) {
+            return false;
+        }
+        int item = optionCell[option] + 1;
+        int x = item;
+        while (optionOf[x] != option) {
+            x = dlink[x];
+        }
+        cover(item);
+        chosen[0] = item;
+        choice[0] = x;
+        apply(x);
+        level = base = 1;
+        resume = ENTER;
+        return true;
+    }
+
+    // Cherche la prochaine solution sous le préfixe, en s'arrêtant après
+    // budget noeuds (budget < 0 : sans limite) ou quand le jeton est annulé.
+    // Un nouvel appel reprend la recherche là où elle s'était arrêtée.
+    SearchStatus run(const CancellationToken* token, long long budget) {
+        if (token && token->isCancelled()) {
+            return SEARCH_INTERRUPTED;
+        }
+        int untilCheck = checkInterval;
+        for (long long n = 0;;) {
+            if (resume == ENTER) {
+                // Toutes les cases sont couvertes : solution
+                if (rlink[0] == 0) {
+                    resume = BACKTRACK;
+                    return SEARCH_FOUND;
+                }
+                int item = mostConstrainedItem();
+                cover(item);
+                chosen[level] = item;
+                choice[level] = dlink[item];
+                resume = TRY;
+            } else if (resume == BACKTRACK) {
+                if (level == base) {
+                    return SEARCH_EXHAUSTED;
+                }
+                --level;
+                retract(choice[level]);
+                choice[level] = dlink[choice[level]];
+                resume = TRY;
+            }
+            // Option suivante de la case en cours, en sautant les copies prématurées
+            int item = chosen[level];
+            int x = choice[level];
+            while (x != item && blocked(x)) {
+                x = dlink[x];
+            }
+            choice[level] = x;
+            if (x == item) {
+                uncover(item);
+                resume = BACKTRACK;
+                continue;
+            }
+            apply(x);
+            ++level;
+            ++nodes;
+            resume = ENTER;
+            if (--untilCheck == 0) {
+                untilCheck = checkInterval;
+                if (token && token->isCancelled()) {
+                    return SEARCH_INTERRUPTED;
+                }
+            }
+            if (budget >= 0 && ++n >= budget) {
+                return SEARCH_INTERRUPTED;
+            }
+        }
+    }
+
+    bool solve(const CancellationToken* token = 0) {
+        return run(token, -1) == SEARCH_FOUND;
+    }
+
+    // Appelle visit(*this) à chaque solution distincte sous le préfixe et
+    // renvoie leur nombre.
+    template<class Visitor>
+    long long forEachSolution(Visitor visit, const CancellationToken* token = 0) {
+        long long count = 0;
+        while (run(token, -1) == SEARCH_FOUND) {
+            visit(*this);
+            ++count;
+        }
+        return count;
+    }
+
+    long long countSolutions(const CancellationToken* token = 0) {
+        return forEachSolution([](const DancingLinks&) {}, token);
+    }
+
+    // Tuile posée en (0,0), ramenée à la première de ses copies : c'est sous
+    // elle que les solveurs comptent les solutions par tuile de départ.
+    int startTile() const {
+        for (int l = 0; l < level; ++l) {
+            if (optionCell[optionOf[choice[l]]] == 0) {
+                return firstOfType[optionTile[optionOf[choice[l]]]];
+            }
+        }
+        return -1;
+    }
+
+    // Plateau des cases couvertes, reconstruit à la demande.
+    const MacMahonBoard& getBoard() const {
+        for (int cell = 0; cell < cellCount; ++cell) {
+            board.placeTile(cell / board.cols(), cell % board.cols(), MacMahonTile());
+        }
+        for (int l = 0; l < level; ++l) {
+            int option = optionOf[choice[l]];
+            int cell = optionCell[option];
+            board.placeTile(cell / board.cols(), cell % board.cols(), tiles[optionTile[option]]);
+        }
+        return board;
+    }
+
+    long long getNodes() const {
+        return nodes;
+    }
+
+    // Taille de la matrice : options et noeuds (intercalaires compris).
+    int getOptions() const {
+        return int(optionCell.size());
+    }
+
+    int getMatrixNodes() const {
+        return int(top.size());
+    }
+
+private:
+    // Étape où reprend run() : couvrir une nouvelle case, essayer l'option
+    // suivante de la case en cours, ou revenir à la case précédente.
+    enum Step {
+        ENTER,
+        TRY,
+        BACKTRACK
+    };
+
+    int newNode(int item, int color) {
+        top.push_back(item);
+        ulink.push_back(0);
+        dlink.push_back(0);
+        colors.push_back(color);
+        optionOf.push_back(-1);
+        return int(top.size()) - 1;
+    }
+
+    // Ajoute à l'option en cours un noeud de l'élément, en bas de sa colonne.
+    void addToItem(int item, int color) {
+        int x = newNode(item, color);
+        ulink[x] = ulink[item];
+        dlink[x] = item;
+        dlink[ulink[item]] = x;
+        ulink[item] = x;
+        ++len[item];
+    }
+
+    // Case non couverte qui a le moins d'options (la première en cas d'égalité).
+    int mostConstrainedItem() const {
+        int best = rlink[0], bestLen = len[best];
+        for (int i = rlink[best]; i != 0 && bestLen > 0; i = rlink[i]) {
+            if (len[i] < bestLen) {
+                best = i;
+                bestLen = len[i];
+            }
+        }
+        return best;
+    }
+
+    // Option d'une copie dont la copie précédente n'est pas encore posée.
+    bool blocked(int x) const {
+        int previous = previousCopy[optionPiece[optionOf[x]]];
+        return previous >= 0 && !used[previous];
+    }
+
+    // Retire des colonnes les autres noeuds de l'option de p.
+    void hide(int p) {
+        for (int q = p + 1; q != p;) {
+            int item = top[q], u = ulink[q], d = dlink[q];
+            if (item <= 0) {
+                q = u;
+            } else {
+                if (colors[q] >= 0) {
+                    dlink[u] = d;
+                    ulink[d] = u;
+                    --len[item];
+                }
+                ++q;
+            }
+        }
+    }
+
+    void unhide(int p) {
+        for (int q = p - 1; q != p;) {
+            int item = top[q], u = ulink[q], d = dlink[q];
+            if (item <= 0) {
+                q = d;
+            } else {
+                if (colors[q] >= 0) {
+                    dlink[u] = q;
+                    ulink[d] = q;
+                    ++len[item];
+                }
+                --q;
+            }
+        }
+    }
+
+    void cover(int item) {
+        for (int p = dlink[item]; p != item; p = dlink[p]) {
+            hide(p);
+        }
+        int l = llink[item], r = rlink[item];
+        rlink[l] = r;
+        llink[r] = l;
+    }
+
+    void uncover(int item) {
+        int l = llink[item], r = rlink[item];
+        rlink[l] = item;
+        llink[r] = item;
+        for (int p = ulink[item]; p != item; p = ulink[p]) {
+            unhide(p);
+        }
+    }
+
+    // L'élément coloré prend la couleur de p : les options qui lui donnent
+    // la même sont gardées (marquées), les autres retirées.
+    void purify(int p) {
+        int color = colors[p], item = top[p];
+        for (int q = dlink[item]; q != item; q = dlink[q]) {
+            if (colors[q] == color) {
+                colors[q] = -1;
+            } else {
+                hide(q);
+            }
+        }
+    }
+
+    void unpurify(int p) {
+        int color = colors[p], item = top[p];
+        for (int q = ulink[item]; q != item; q = ulink[q]) {
+            if (colors[q] < 0) {
+                colors[q] = color;
+            } else {
+                unhide(q);
+            }
+        }
+    }
+
+    // Applique les autres éléments de l'option choisie en x.
+    void apply(int x) {
+        for (int p = x + 1; p != x;) {
+            int item = top[p];
+            if (item <= 0) {
+                p = ulink[p];
+                continue;
+            }
+            if (colors[p] == 0) {
+                cover(item);
+            } else if (colors[p] > 0) {
+                purify(p);
+            }
+            ++p;
+        }
+        used[optionPiece[optionOf[x]]] = true;
+    }
+
+    // Annule apply(x), en ordre inverse.
+    void retract(int x) {
+        used[optionPiece[optionOf[x]]] = false;
+        for (int p = x - 1; p != x;) {
+            int item = top[p];
+            if (item <= 0) {
+                p = dlink[p];
+                continue;
+            }
+            if (colors[p] == 0) {
+                uncover(item);
+            } else if (colors[p] > 0) {
+                unpurify(p);
+            }
+            --p;
+        }
+    }
+
+    mutable MacMahonBoard board;
+    const std::vector<MacMahonTile>& tiles;
+    int cellCount;
+    int itemCount;
+    long long nodes;                // nombre d'options choisies par run()
+    int checkInterval;
+    int level = 0;                  // nombre de cases couvertes
+    int base = 0;                   // longueur du préfixe fixé par place()
+    Step resume = ENTER;
+    // Éléments : liens de la liste des éléments actifs et nombre d'options
+    std::vector<int> llink, rlink, len;
+    // Noeuds : élément (intercalaire si <= 0), liens verticaux, couleur
+    // (0 sans couleur, -1 déjà imposée) et option
+    std::vector<int> top, ulink, dlink, colors, optionOf;
+    // Options : case, tuile (indice dans tiles) et tuile du jeu
+    std::vector<int> optionCell, optionTile, optionPiece;
+    // Indexés par niveau : case couverte et noeud de l'option essayée
+    std::vector<int> chosen, choice;
+    std::vector<int> previousCopy;  // par tuile du jeu, -1 sans copie précédente
+    std::vector<bool> used;         // tuiles du jeu posées
+    std::vector<int> firstOfType;   // par indice de tiles, première tuile identique
+};
+
+#endif
@@ -0,0 +1,122 @@
+#ifndef MACMAHON_FILTER_H
+#define MACMAHON_FILTER_H
+
+#include <cstdint>
+#include <vector>
+
+// MACMAHON_NO_SIMD force le chemin scalaire.
+#if !defined(MACMAHON_NO_SIMD) && defined(__AVX2__)
+#define MACMAHON_FILTER_AVX2
+#elif !defined(MACMAHON_NO_SIMD) && defined(__SSE2__)
+#define MACMAHON_FILTER_SSE2
+#endif
+
+#if defined(MACMAHON_FILTER_AVX2) || defined(MACMAHON_FILTER_SSE2)
+#include <immintrin.h>
+#endif
+
+#include "macmahon.h"
+#include "index.h"
+
+// Filtre de toutes les tuiles à la fois contre une contrainte de case.
+// Les tuiles compactées sont rangées dans un tableau d'octets contigu et
+// aligné (une colonne par champ : octet de la tuile, et octet de test du
+// coin) ; une contrainte se réduit alors à (octet & mask) == value, évalué
+// sur 32 tuiles par instruction en AVX2, 16 en SSE2, et le résultat des
+// comparaisons est directement l'ensemble des tuiles candidates. Le chemin
+// scalaire donne exactement le même ensemble et sert de référence.
+class TileFilter {
+public:
+    explicit TileFilter(const std::vector<MacMahonTile>& tiles)
+        : size(int(tiles.size()) < TileSet::CAPACITY ? int(tiles.size()) : TileSet::CAPACITY),
+          valid(TileSet::firstN(size)) {
+        for (int i = 0; i < TileSet::CAPACITY; ++i) {
+            uint8_t b = i < size ? tiles[i].getBits() : 0;
+            bits[i] = b;
+            // Gauche et haut identiques <=> ((b ^ (b >> 2)) & 3) == 0
+            corner[i] = uint8_t(b ^ (b >> 2));
+        }
+    }
+
+    // Nom du chemin choisi à la compilation.
+    static const char* implementation() {
+#if defined(MACMAHON_FILTER_AVX2)
+        return "avx2";
+#elif defined(MACMAHON_FILTER_SSE2)
+        return "sse2";
+#else
+        return "scalaire";
+#endif
+    }
+
+    // Tuiles pouvant occuper une case soumise à la contrainte c.
+    TileSet matching(const CellConstraint& c) const {
+        if (c.conflict) {
+            return TileSet();
+        }
+        if (c.corner) {
+            return compare(corner, size, 3, 0) & valid;
+        }
+        return compare(bits, size, c.mask, c.value) & valid;
+    }
+
+    // Même résultat, une tuile à la fois.
+    TileSet matchingScalar(const CellConstraint& c) const {
+        if (c.conflict) {
+            return TileSet();
+        }
+        if (c.corner) {
+            return compareScalar(corner, size, 3, 0);
+        }
+        return compareScalar(bits, size, c.mask, c.value);
+    }
+
+private:
+    static TileSet compareScalar(const uint8_t* data, int size, uint8_t mask, uint8_t value) {
+        uint64_t words[TileSet::WORDS] = {0};
+        for (int i = 0; i < size; ++i) {
+            words[i >> 6] |= uint64_t((data[i] & mask) == value) << (i & 63);
+        }
+        return TileSet::fromWords(words);
+    }
+
+#if defined(MACMAHON_FILTER_AVX2)
+    static TileSet compare(const uint8_t* data, int size, uint8_t mask, uint8_t value) {
+        const __m256i m = _mm256_set1_epi8(char(mask));
+        const __m256i v = _mm256_set1_epi8(char(value));
+        uint64_t words[TileSet::WORDS] = {0};
+        // Seuls les mots qui contiennent des tuiles sont calculés
+        for (int w = 0; w < (size + 63) / 64; ++w) {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + 64 * w));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + 64 * w + 32));
+            uint32_t lo = uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(a, m), v)));
+            uint32_t hi = uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(b, m), v)));
+            words[w] = uint64_t(lo) | (uint64_t(hi) << 32);
+        }
+        return TileSet::fromWords(words);
+    }
+#elif defined(MACMAHON_FILTER_SSE2)
+    static TileSet compare(const uint8_t* data, int size, uint8_t mask, uint8_t value) {
+        const __m128i m = _mm_set1_epi8(char(mask));
+        const __m128i v = _mm_set1_epi8(char(value));
+        uint64_t words[TileSet::WORDS] = {0};
+        for (int k = 0; k < (size + 15) / 16; ++k) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16 * k));
+            uint64_t found = uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(a, m), v)));
+            words[k >> 2] |= found << (16 * (k & 3));
+        }
+        return TileSet::fromWords(words);
+    }
+#else
+    static TileSet compare(const uint8_t* data, int size, uint8_t mask, uint8_t value) {
+        return compareScalar(data, size, mask, value);
+    }
+#endif
+
+    alignas(32) uint8_t bits[TileSet::CAPACITY];
+    alignas(32) uint8_t corner[TileSet::CAPACITY];
+    int size;
+    TileSet valid;
+};
+
+#endif
@@ -0,0 +1,223 @@
+#ifndef MACMAHON_INDEX_H
+#define MACMAHON_INDEX_H
+
+#include <cstdint>
+#include <vector>
+
+#include "macmahon.h"
+
+// Ensemble de tuiles sur 256 bits : une tuile est désignée par son indice dans
+// le vecteur lu par loadPuzzle. La capacité couvre les orientations de
+// --rotations (jusqu'à quatre par tuile, 135 pour le 6x6 fourni) ; sans
+// rotation, les mots du haut restent vides et les branches qui les testent
+// sont prévisibles.
+class TileSet {
+public:
+    static const int CAPACITY = 256;
+    static const int WORDS = CAPACITY / 64;
+
+    TileSet() : w{0, 0, 0, 0} {}
+
+    static TileSet firstN(int n) {
+        TileSet s;
+        for (int i = 0; i < WORDS; ++i) {
+            int bits = n - 64 * i;
+            s.w[i] = bits >= 64 ? ~0ull : (bits > 0 ? (1ull << bits) - 1 : 0);
+        }
+        return s;
+    }
+
+    // Ensemble donné par ses mots de 64 bits (tuiles 0-63, puis 64-127...).
+    static TileSet fromWords(const uint64_t* words) {
+        TileSet s;
+        for (int i = 0; i < WORDS; ++i) {
+            s.w[i] = words[i];
+        }
+        return s;
+    }
+
+    // Mot i de l'ensemble (tuiles 64 * i à 64 * i + 63).
+    uint64_t word(int i) const {
+        return w[i];
+    }
+
+    void set(int i) {
+        w[i >> 6] |= 1ull << (i & 63);
+    }
+
+    void reset(int i) {
+        w[i >> 6] &= ~(1ull << (i & 63));
+    }
+
+    bool test(int i) const {
+        return (w[i >> 6] >> (i & 63)) & 1;
+    }
+
+    bool empty() const {
+        return (w[0] | w[1] | w[2] | w[3]) == 0;
+    }
+
+    int count() const {
+        return __builtin_popcountll(w[0]) + __builtin_popcountll(w[1]) + __builtin_popcountll(w[2]) +
+               __builtin_popcountll(w[3]);
+    }
+
+    // Retire et renvoie le plus petit indice de l'ensemble (qui ne doit pas être vide).
+    int popFirst() {
+        if (w[0]) {
+            return pop(0);
+        }
+        if (w[1]) {
+            return pop(1);
+        }
+        return w[2] ? pop(2) : pop(3);
+    }
+
+    TileSet operator&(const TileSet& o) const {
+        TileSet s;
+        for (int i = 0; i < WORDS; ++i) {
+            s.w[i] = w[i] & o.w[i];
+        }
+        return s;
+    }
+
+    // Éléments de l'ensemble absents de o.
+    TileSet without(const TileSet& o) const {
+        TileSet s;
+        for (int i = 0; i < WORDS; ++i) {
+            s.w[i] = w[i] & ~o.w[i];
+        }
+        return s;
+    }
+
+    TileSet operator|(const TileSet& o) const {
+        TileSet s;
+        for (int i = 0; i < WORDS; ++i) {
+            s.w[i] = w[i] | o.w[i];
+        }
+        return s;
+    }
+
+    bool operator==(const TileSet& o) const {
+        return ((w[0] ^ o.w[0]) | (w[1] ^ o.w[1]) | (w[2] ^ o.w[2]) | (w[3] ^ o.w[3])) == 0;
+    }
+
+private:
+    int pop(int k) {
+        int i = __builtin_ctzll(w[k]);
+        w[k] &= w[k] - 1;
+        return 64 * k + i;
+    }
+
+    uint64_t w[WORDS];
+};
+
+// Mode --rotations : orientations distinctes de chaque tuile, obtenues par
+// quarts de tour et rangées tuile par tuile. Une tuile invariante par un
+// demi-tour n'en a que deux, une tuile d'une seule couleur une seule. Les
+// moteurs travaillent sur ce vecteur comme sur un jeu ordinaire ; pieceOf[k]
+// reçoit l'indice dans tiles de la tuile dont l'orientation k est tirée.
+inline std::vector<MacMahonTile> orientTiles(const std::vector<MacMahonTile>& tiles, std::vector<int>& pieceOf) {
+    std::vector<MacMahonTile> orientations;
+    pieceOf.clear();
+    for (size_t i = 0; i < tiles.size(); ++i) {
+        size_t first = orientations.size();
+        for (int turns = 0; turns < 4; ++turns) {
+            MacMahonTile rotated = rotateTile(tiles[i], turns);
+            bool seen = false;
+            for (size_t k = first; k < orientations.size() && !seen; ++k) {
+                seen = orientations[k].getBits() == rotated.getBits();
+            }
+            if (!seen) {
+                orientations.push_back(rotated);
+                pieceOf.push_back(int(i));
+            }
+        }
+    }
+    return orientations;
+}
+
+// Index des tuiles compatibles, construit une fois après loadPuzzle.
+// La clé est formée des côtés contraints (4 bits) et des couleurs qu'ils
+// imposent (la valeur compactée de la contrainte) : elle couvre donc la
+// couleur requise à gauche, en haut et la classe de bordure de la case. Une
+// clé supplémentaire représente le coin (0,0), une autre (toujours vide) les
+// contraintes contradictoires.
+// En mode --rotations, l'index est construit sur les orientations de
+// orientTiles : une consultation rend directement les couples (tuile,
+// orientation) qui conviennent, et pieceOf relie chacun à sa tuile.
+class CompatibilityIndex {
+public:
+    static const int CORNER_KEY = 16 * 256;
+    static const int CONFLICT_KEY = CORNER_KEY + 1;
+    static const int KEY_COUNT = CONFLICT_KEY + 1;
+
+    // pieces : tuile du jeu de chaque orientation (voir orientTiles), vide
+    // si chaque tuile n'a que son orientation lue.
+    explicit CompatibilityIndex(const std::vector<MacMahonTile>& tiles,
+                                const std::vector<int>& pieces = std::vector<int>())
+        : masks(KEY_COUNT), pieces(pieces) {
+        for (int sides = 0; sides < 16; ++sides) {
+            for (int value = 0; value < 256; ++value) {
+                CellConstraint c = {maskOfSides(sides), uint8_t(value), false, false};
+                if ((value & ~c.mask) == 0) {
+                    fill(keyOf(c), c, tiles);
+                }
+            }
+        }
+        CellConstraint corner = {0, 0, true, false};
+        fill(CORNER_KEY, corner, tiles);
+    }
+
+    static int keyOf(const CellConstraint& c) {
+        if (c.conflict) {
+            return CONFLICT_KEY;
+        }
+        if (c.corner) {
+            return CORNER_KEY;
+        }
+        // Un bit par côté contraint : bit de poids faible de chaque paire du masque
+        int m = c.mask & 0x55;
+        int sides = (m & 1) | ((m >> 1) & 2) | ((m >> 2) & 4) | ((m >> 3) & 8);
+        return (sides << 8) | c.value;
+    }
+
+    // Tuiles pouvant occuper une case soumise à la contrainte c.
+    const TileSet& candidates(const CellConstraint& c) const {
+        return masks[keyOf(c)];
+    }
+
+    // Même chose à partir d'une clé déjà calculée par keyOf.
+    const TileSet& candidatesByKey(int key) const {
+        return masks[key];
+    }
+
+    // Tuile du jeu dont l'indice tile est une orientation.
+    int pieceOf(int tile) const {
+        return pieces.empty() ? tile : pieces[tile];
+    }
+
+private:
+    static uint8_t maskOfSides(int sides) {
+        uint8_t mask = 0;
+        for (int side = LEFT; side <= BOTTOM; ++side) {
+            if (sides & (1 << side)) {
+                mask |= sideMask(side);
+            }
+        }
+        return mask;
+    }
+
+    void fill(int key, const CellConstraint& c, const std::vector<MacMahonTile>& tiles) {
+        for (int i = 0; i < int(tiles.size()) && i < TileSet::CAPACITY; ++i) {
+            if (fitsConstraint(c, tiles[i])) {
+                masks[key].set(i);
+            }
+        }
+    }
+
+    std::vector<TileSet> masks;
+    std::vector<int> pieces;
+};
+
+#endif
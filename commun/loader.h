@@ -0,0 +1,361 @@
+#ifndef MACMAHON_LOADER_H
+#define MACMAHON_LOADER_H
+
+#include <cerrno>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "macmahon.h"
+#include "index.h"
+
+// Chargement d'un fichier *_colorv2.txt : le fichier est projeté en mémoire
+// et lu en une seule passe, sans flux. Format : "ROWS COLS", puis ROWS * COLS
+// tuiles de quatre lettres (gauche, haut, droite, bas) parmi R, G et B,
+// séparées par des blancs quelconques. Le jeu est refusé s'il ne peut pas
+// avoir de solution à cause de sa bordure (voir borderSolvable).
+
+enum LoadStatus {
+    LOAD_OK,
+    LOAD_CANNOT_OPEN,       // fichier absent ou illisible
+    LOAD_BAD_HEADER,        // dimensions absentes ou nulles
+    LOAD_TOO_LARGE,         // plus de MAX_BOARD_CELLS tuiles, ou d'orientations que TileSet::CAPACITY
+    LOAD_BAD_COLOR,         // lettre autre que R, G ou B
+    LOAD_MISSING_TILES,     // moins de ROWS * COLS tuiles
+    LOAD_EXTRA_DATA,        // données après la dernière tuile
+    LOAD_UNSOLVABLE,        // aucune bordure possible : pas de solution
+    LOAD_BAD_CONTAINER      // conteneur binaire corrompu (commun/container.h)
+};
+
+// Résultat du chargement : statut, ligne du fichier concernée (0 si sans
+// objet) et message lisible.
+struct LoadResult {
+    LoadStatus status;
+    int line;
+    std::string message;
+
+    bool ok() const {
+        return status == LOAD_OK;
+    }
+};
+
+// "fichier:ligne: message", à afficher sur la sortie d'erreur.
+inline std::string describeLoadError(const std::string& filename, const LoadResult& result) {
+    return filename + (result.line > 0 ? ":" + std::to_string(result.line) : std::string()) + ": " + result.message;
+}
+
+// Contenu d'un fichier en lecture seule, libéré à la destruction. Les gros
+// fichiers sont projetés en mémoire ; en dessous de SMALL_FILE octets (tous
+// les plateaux, 128 tuiles au plus), un seul read() dans un tampon interne
+// coûte moins cher que mmap, munmap et le défaut de page.
+class MappedFile {
+public:
+    static const size_t SMALL_FILE = 16384;
+
+    MappedFile() : fd(-1), bytes(0), length(0), mapped(false) {}
+
+    ~MappedFile() {
+        close();
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& filename) {
+        close();
+        fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+            close();
+            return false;
+        }
+        length = size_t(info.st_size);
+        if (length <= SMALL_FILE) {
+            size_t done = 0;
+            while (done < length) {
+                ssize_t got = read(fd, buffer + done, length - done);
+                if (got < 0) {
+                    close();
+                    return false;
+                }
+                if (got == 0) {
+                    break;
+                }
+                done += size_t(got);
+            }
+            length = done;
+            bytes = buffer;
+        } else {
+            void* p = mmap(0, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) {
+                close();
+                return false;
+            }
+            bytes = static_cast<const char*>(p);
+            mapped = true;
+        }
+        return true;
+    }
+
+    void close() {
+        if (mapped) {
+            munmap(const_cast<char*>(bytes), length);
+        }
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        fd = -1;
+        bytes = 0;
+        length = 0;
+        mapped = false;
+    }
+
+    const char* data() const {
+        return bytes;
+    }
+
+    size_t size() const {
+        return length;
+    }
+
+private:
+    int fd;
+    const char* bytes;
+    size_t length;
+    bool mapped;
+    char buffer[SMALL_FILE];
+};
+
+// Conditions nécessaires imposées par la bordure. Les règles de placement
+// donnent une couleur unique f aux côtés gauches de la première colonne et aux
+// côtés hauts de la première ligne (égales par la règle du coin), une couleur
+// r aux côtés droits de la dernière colonne et une couleur b aux côtés bas de
+// la dernière ligne. Chaque côté intérieur gauche fait face à un côté droit de
+// même couleur, donc pour toute couleur c :
+//   #gauche(c) - ROWS * [f == c] == #droite(c) - ROWS * [r == c]
+//   #haut(c)   - COLS * [f == c] == #bas(c)    - COLS * [b == c]
+// et une tuile au moins doit avoir ses côtés gauche et haut de couleur f.
+inline bool borderSolvable(int rows, int cols, const std::vector<MacMahonTile>& tiles) {
+    int count[4][4] = {};
+    bool corner[4] = {};
+    for (const MacMahonTile& tile : tiles) {
+        for (int side = LEFT; side <= BOTTOM; ++side) {
+            ++count[side][tile.getColorAt(side)];
+        }
+        if (tile.getColorAt(LEFT) == tile.getColorAt(TOP)) {
+            corner[tile.getColorAt(LEFT)] = true;
+        }
+    }
+    for (int f = BLUE; f <= RED; ++f) {
+        if (!corner[f]) {
+            continue;
+        }
+        for (int r = BLUE; r <= RED; ++r) {
+            for (int b = BLUE; b <= RED; ++b) {
+                bool balanced = true;
+                for (int c = BLUE; c <= RED && balanced; ++c) {
+                    balanced = count[LEFT][c] - rows * (f == c) == count[RIGHT][c] - rows * (r == c) &&
+                               count[TOP][c] - cols * (f == c) == count[BOTTOM][c] - cols * (b == c);
+                }
+                if (balanced) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+// Même chose quand les tuiles peuvent tourner (--rotations) : seul le total
+// des côtés de chaque couleur compte. Les côtés intérieurs vont par paires de
+// même couleur, donc pour toute couleur c :
+//   #côtés(c) - (ROWS + COLS) * [f == c] - ROWS * [r == c] - COLS * [b == c]
+// doit être pair et positif, et une tuile au moins doit avoir deux côtés
+// consécutifs de couleur f.
+inline bool rotatedBorderSolvable(int rows, int cols, const std::vector<MacMahonTile>& tiles) {
+    int count[4] = {};
+    bool corner[4] = {};
+    for (const MacMahonTile& tile : tiles) {
+        for (int side = LEFT; side <= BOTTOM; ++side) {
+            ++count[tile.getColorAt(side)];
+            if (tile.getColorAt(side) == tile.getColorAt((side + 1) % 4)) {
+                corner[tile.getColorAt(side)] = true;
+            }
+        }
+    }
+    for (int f = BLUE; f <= RED; ++f) {
+        if (!corner[f]) {
+            continue;
+        }
+        for (int r = BLUE; r <= RED; ++r) {
+            for (int b = BLUE; b <= RED; ++b) {
+                bool paired = true;
+                for (int c = BLUE; c <= RED && paired; ++c) {
+                    int inner = count[c] - (rows + cols) * (f == c) - rows * (r == c) - cols * (b == c);
+                    paired = inner >= 0 && inner % 2 == 0;
+                }
+                if (paired) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+// Charge le fichier dans rows, cols et tiles (exactement rows * cols tuiles).
+// Avec rotations, la bordure est vérifiée pour des tuiles qui peuvent tourner.
+inline LoadResult loadPuzzle(const std::string& filename, int& rows, int& cols, std::vector<MacMahonTile>& tiles,
+                             bool rotations = false) {
+    rows = cols = 0;
+    tiles.clear();
+    MappedFile file;
+    if (!file.open(filename)) {
+        return LoadResult{LOAD_CANNOT_OPEN, 0, "impossible d'ouvrir le fichier"};
+    }
+    const char* p = file.data();
+    const char* end = p + file.size();
+    int line = 1;
+
+    // Avance jusqu'au prochain caractère non blanc en comptant les lignes
+    auto skipSpaces = [&]() {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) {
+            line += *p == '\n';
+            ++p;
+        }
+    };
+    auto readDimension = [&](int& value) {
+        skipSpaces();
+        value = 0;
+        const char* start = p;
+        while (p < end && *p >= '0' && *p <= '9' && value < 1000000) {
+            value = 10 * value + (*p++ - '0');
+        }
+        return p > start && value > 0 && (p == end || !(*p >= '0' && *p <= '9'));
+    };
+
+    if (!readDimension(rows) || !readDimension(cols)) {
+        rows = cols = 0;
+        return LoadResult{LOAD_BAD_HEADER, line, "dimensions du plateau absentes ou invalides"};
+    }
+    if (rows > MAX_BOARD_CELLS || cols > MAX_BOARD_CELLS || rows * cols > MAX_BOARD_CELLS) {
+        return LoadResult{LOAD_TOO_LARGE, 1, "plateau " + std::to_string(rows) + "x" + std::to_string(cols) +
+                                                 " : plus de " + std::to_string(MAX_BOARD_CELLS) + " tuiles"};
+    }
+
+    int cells = rows * cols;
+    tiles.resize(cells);
+    for (int i = 0; i < cells; ++i) {
+        TileColor colors[4];
+        for (int side = LEFT; side <= BOTTOM; ++side) {
+            skipSpaces();
+            if (p == end) {
+                return LoadResult{LOAD_MISSING_TILES, line, std::to_string(i) + " tuiles complètes sur " +
+                                                                std::to_string(cells) + " attendues"};
+            }
+            switch (*p) {
+                case 'R':
+                    colors[side] = RED;
+                    break;
+                case 'G':
+                    colors[side] = GREEN;
+                    break;
+                case 'B':
+                    colors[side] = BLUE;
+                    break;
+                default:
+                    return LoadResult{LOAD_BAD_COLOR, line, std::string("couleur '") + *p + "' inconnue (tuile " +
+                                                                std::to_string(i) + ", attendu R, G ou B)"};
+            }
+            ++p;
+        }
+        tiles[i].setColors(colors[LEFT], colors[TOP], colors[RIGHT], colors[BOTTOM]);
+    }
+    skipSpaces();
+    if (p != end) {
+        return LoadResult{LOAD_EXTRA_DATA, line, "données après la tuile " + std::to_string(cells - 1)};
+    }
+    if (!(rotations ? rotatedBorderSolvable(rows, cols, tiles) : borderSolvable(rows, cols, tiles))) {
+        return LoadResult{LOAD_UNSOLVABLE, 0, "aucune couleur de bordure possible : le jeu n'a pas de solution"};
+    }
+    return LoadResult{LOAD_OK, 0, std::string()};
+}
+
+// Type de tuile : une tuile et son nombre de copies identiques dans le jeu.
+struct TileType {
+    MacMahonTile tile;
+    int count;
+};
+
+// Multi-ensemble des tuiles du jeu, par ordre de première apparition. Les
+// moteurs gardent un indice par tuile mais ne branchent que sur la première
+// copie restante de chaque type, ce qui revient à choisir parmi ces types.
+inline std::vector<TileType> tileTypes(const std::vector<MacMahonTile>& tiles) {
+    std::vector<TileType> types;
+    for (const MacMahonTile& tile : tiles) {
+        size_t t = 0;
+        while (t < types.size() && types[t].tile.getBits() != tile.getBits()) {
+            ++t;
+        }
+        if (t == types.size()) {
+            types.push_back(TileType{tile, 0});
+        }
+        ++types[t].count;
+    }
+    return types;
+}
+
+// --rotations : remplace tiles par ses orientations distinctes (voir
+// orientTiles) et remplit pieces pour CompatibilityIndex. Les orientations
+// doivent tenir dans un TileSet.
+inline LoadResult orientPuzzle(std::vector<MacMahonTile>& tiles, std::vector<int>& pieces) {
+    std::vector<MacMahonTile> orientations = orientTiles(tiles, pieces);
+    if (orientations.size() > size_t(TileSet::CAPACITY)) {
+        return LoadResult{LOAD_TOO_LARGE, 0, std::to_string(orientations.size()) + " orientations distinctes : plus de " +
+                                                 std::to_string(TileSet::CAPACITY)};
+    }
+    tiles.swap(orientations);
+    return LoadResult{LOAD_OK, 0, std::string()};
+}
+
+// Plateau au format lu par loadPuzzle, une tuile par ligne.
+inline std::string formatPuzzle(int rows, int cols, const std::vector<MacMahonTile>& tiles) {
+    static const char letters[] = {' ', 'B', 'G', 'R'};
+    std::string text = std::to_string(rows) + " " + std::to_string(cols) + "\n";
+    for (const MacMahonTile& tile : tiles) {
+        for (int side = LEFT; side <= BOTTOM; ++side) {
+            text += letters[tile.getColorAt(side)];
+            text += side < BOTTOM ? ' ' : '\n';
+        }
+    }
+    return text;
+}
+
+inline bool savePuzzle(const std::string& filename, int rows, int cols, const std::vector<MacMahonTile>& tiles) {
+    std::ofstream out(filename);
+    out << formatPuzzle(rows, cols, tiles);
+    return bool(out);
+}
+
+// Crée le répertoire de sortie s'il n'existe pas encore (un seul niveau).
+inline bool makeDirectory(const std::string& directory) {
+    return ::mkdir(directory.c_str(), 0777) == 0 || errno == EEXIST;
+}
+
+// directory/name, sans doubler la barre finale de directory.
+inline std::string joinPath(const std::string& directory, const std::string& name) {
+    if (directory.empty() || directory[directory.size() - 1] == '/') {
+        return directory + name;
+    }
+    return directory + "/" + name;
+}
+
+#endif
@@ -0,0 +1,251 @@
+#ifndef MACMAHON_H
+#define MACMAHON_H
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Représentation commune aux trois versions du solveur.
+// Une tuile tient dans un seul octet (2 bits par côté) et le plateau est un
+// tableau plat contigu : copier un plateau ne coûte qu'une allocation et la
+// comparaison des côtés se fait par masques.
+
+enum TileColor {
+    EMPTY,
+    BLUE,
+    GREEN,
+    RED
+};
+
+// Ordre des côtés tel qu'il est lu dans les fichiers *_colorv2.txt.
+enum TileSide {
+    LEFT,
+    TOP,
+    RIGHT,
+    BOTTOM
+};
+
+// Masque des 2 bits d'un côté dans la tuile compactée.
+inline uint8_t sideMask(int side) {
+    return uint8_t(3u << (2 * side));
+}
+
+// Valeur compactée d'une couleur placée sur un côté.
+inline uint8_t sideValue(int side, TileColor color) {
+    return uint8_t(unsigned(color) << (2 * side));
+}
+
+class MacMahonTile {
+public:
+    MacMahonTile() : bits(0) {}
+
+    void setColors(TileColor left, TileColor top, TileColor right, TileColor bottom) {
+        bits = uint8_t(sideValue(LEFT, left) | sideValue(TOP, top) |
+                       sideValue(RIGHT, right) | sideValue(BOTTOM, bottom));
+    }
+
+    TileColor getColorAt(int position) const {
+        return TileColor((bits >> (2 * position)) & 3u);
+    }
+
+    uint8_t getBits() const {
+        return bits;
+    }
+
+private:
+    uint8_t bits;
+};
+
+// Tuile tournée de quarterTurns quarts de tour dans le sens horaire. Les
+// côtés sont rangés dans le sens horaire (gauche, haut, droite, bas) : la
+// rotation est une rotation des 8 bits de la tuile compactée.
+inline MacMahonTile rotateTile(const MacMahonTile& tile, int quarterTurns) {
+    TileColor colors[4];
+    for (int side = LEFT; side <= BOTTOM; ++side) {
+        colors[(side + quarterTurns) % 4] = tile.getColorAt(side);
+    }
+    MacMahonTile rotated;
+    rotated.setColors(colors[LEFT], colors[TOP], colors[RIGHT], colors[BOTTOM]);
+    return rotated;
+}
+
+// Plus grand plateau accepté, en cases. Les ensembles de tuiles (TileSet)
+// sont plus larges, pour les orientations de --rotations.
+const int MAX_BOARD_CELLS = 128;
+
+class MacMahonBoard {
+public:
+    MacMahonBoard(int rows, int cols) : ROWS(rows), COLS(cols), board(rows * cols) {}
+
+    int rows() const {
+        return ROWS;
+    }
+
+    int cols() const {
+        return COLS;
+    }
+
+    void placeTile(int row, int col, const MacMahonTile &tile) {
+        board[row * COLS + col] = tile;
+    }
+
+    const MacMahonTile& getTileAt(int row, int col) const {
+        return board[row * COLS + col];
+    }
+
+    // Ajoute le plateau à out : une ligne par rangée, quatre lettres par
+    // tuile (gauche, haut, droite, bas), tuiles séparées par une tabulation.
+    void appendText(std::string& out) const {
+        static const char letters[] = {' ', 'B', 'G', 'R'};
+        for (int i = 0; i < ROWS; ++i) {
+            for (int j = 0; j < COLS; ++j) {
+                for (int k = 0; k < 4; ++k) {
+                    out += letters[getTileAt(i, j).getColorAt(k)];
+                }
+                out += '\t';
+            }
+            out += '\n';
+        }
+    }
+
+    // Formate le plateau puis l'écrit d'un seul bloc.
+    void display() const {
+        std::string text;
+        appendText(text);
+        std::cout.write(text.data(), std::streamsize(text.size()));
+        std::cout.flush();
+    }
+
+private:
+    int ROWS, COLS;
+    std::vector<MacMahonTile> board;
+};
+
+// Affiche le nombre de solutions de chaque sous-arbre de tuile de départ
+// (counts[i] : solutions dont la case (0,0) porte la tuile i, -1 si la tuile
+// ne peut pas y être posée).
+inline void displaySubtreeCounts(const std::vector<MacMahonTile>& tiles, const std::vector<long long>& counts) {
+    static const char letters[] = {' ', 'B', 'G', 'R'};
+    for (size_t i = 0; i < counts.size() && i < tiles.size(); ++i) {
+        if (counts[i] < 0) {
+            continue;
+        }
+        std::cout << "  tuile " << i << " (";
+        for (int k = 0; k < 4; ++k) {
+            std::cout << letters[tiles[i].getColorAt(k)];
+        }
+        std::cout << ") : " << counts[i] << std::endl;
+    }
+}
+
+// Contrainte d'une case : la tuile convient si (bits & mask) == value.
+struct CellConstraint {
+    uint8_t mask;
+    uint8_t value;
+    bool corner;    // case (0,0) : côtés gauche et supérieur identiques
+    bool conflict;  // deux voisins imposent des couleurs différentes au même côté
+};
+
+// Couleur imposée sur un côté contraint.
+inline TileColor requiredColor(const CellConstraint& c, int side) {
+    return TileColor((c.value >> (2 * side)) & 3u);
+}
+
+// Ajoute à la contrainte la couleur imposée sur un côté.
+inline void requireColor(CellConstraint& c, int side, TileColor color) {
+    if (c.mask & sideMask(side)) {
+        if ((c.value & sideMask(side)) != sideValue(side, color)) {
+            c.conflict = true;
+        }
+        return;
+    }
+    c.mask |= sideMask(side);
+    c.value |= sideValue(side, color);
+}
+
+// Règle liant une case à un voisin posé : le côté to de la case doit porter
+// la couleur du côté from du voisin.
+struct SideRule {
+    uint8_t from;
+    uint8_t to;
+};
+
+// Règles liant la case (row, col) à son voisin du côté side ; renvoie leur
+// nombre (3 au plus). Chaque règle de l'ancien canPlaceTile lie une case à
+// son voisin du dessus ou de gauche ; elle est écrite ici dans les deux sens,
+// ce qui permet de remplir les cases dans n'importe quel ordre.
+inline int neighborRules(int rows, int cols, int row, int col, int side, SideRule rules[3]) {
+    int n = 0;
+    if (side == TOP || side == BOTTOM) {
+        // Côté commun, puis bordures gauche et droite du plateau
+        rules[n++] = SideRule{uint8_t(side == TOP ? BOTTOM : TOP), uint8_t(side)};
+        if (col == 0) {
+            rules[n++] = SideRule{LEFT, LEFT};
+        }
+        if (col == cols - 1) {
+            rules[n++] = SideRule{RIGHT, RIGHT};
+        }
+    } else {
+        // Côté commun, puis bordures supérieure et inférieure du plateau
+        rules[n++] = SideRule{uint8_t(side == LEFT ? RIGHT : LEFT), uint8_t(side)};
+        if (row == 0) {
+            rules[n++] = SideRule{TOP, TOP};
+        }
+        if (row == rows - 1) {
+            rules[n++] = SideRule{BOTTOM, BOTTOM};
+        }
+    }
+    return n;
+}
+
+// Ajoute la contrainte imposée par la tuile voisine posée du côté side de la
+// case (row, col).
+inline void constrainByNeighbor(CellConstraint& c, int rows, int cols, int row, int col,
+                                int side, const MacMahonTile& neighbor) {
+    SideRule rules[3];
+    int n = neighborRules(rows, cols, row, col, side, rules);
+    for (int i = 0; i < n; ++i) {
+        requireColor(c, rules[i].to, neighbor.getColorAt(rules[i].from));
+    }
+    if (c.corner) {
+        // Tout voisin du coin fixe son côté gauche ou son côté supérieur :
+        // l'égalité des deux devient une contrainte de couleur ordinaire
+        if (c.mask & sideMask(TOP)) {
+            requireColor(c, LEFT, requiredColor(c, TOP));
+        }
+        if (c.mask & sideMask(LEFT)) {
+            requireColor(c, TOP, requiredColor(c, LEFT));
+        }
+        c.corner = false;
+    }
+}
+
+// Construit la contrainte imposée par les voisins déjà posés (au-dessus et à
+// gauche) ; mêmes règles que l'ancien canPlaceTile, condition par condition.
+inline CellConstraint cellConstraint(const MacMahonBoard& board, int row, int col) {
+    CellConstraint c = {0, 0, row == 0 && col == 0, false};
+    if (row > 0) {
+        constrainByNeighbor(c, board.rows(), board.cols(), row, col, TOP, board.getTileAt(row - 1, col));
+    }
+    if (col > 0) {
+        constrainByNeighbor(c, board.rows(), board.cols(), row, col, LEFT, board.getTileAt(row, col - 1));
+    }
+    return c;
+}
+
+inline bool fitsConstraint(const CellConstraint& c, const MacMahonTile& tile) {
+    if (c.conflict) {
+        return false;
+    }
+    if (c.corner) {
+        return tile.getColorAt(LEFT) == tile.getColorAt(TOP);
+    }
+    return (tile.getBits() & c.mask) == c.value;
+}
+
+inline bool canPlaceTile(const MacMahonBoard& board, int row, int col, const MacMahonTile& tile) {
+    return fitsConstraint(cellConstraint(board, row, col), tile);
+}
+
+#endif
@@ -0,0 +1,185 @@
+#ifndef MACMAHON_MEMO_H
+#define MACMAHON_MEMO_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+
+#include "index.h"
+
+// Table de transposition des états sans issue.
+// En remplissage ligne par ligne, une fois une ligne complète, la suite de la
+// recherche ne dépend que des couleurs du bas de cette ligne, des couleurs
+// des bordures gauche et droite et des tuiles restantes : deux préfixes qui
+// ne diffèrent que par l'ordre ou le choix des lignes précédentes mènent au
+// même sous-problème. Le moteur y enregistre chaque sous-problème épuisé sans
+// aucune solution et coupe la branche quand il le retrouve.
+// La clé est formée des tuiles restantes (la ligne s'en déduit) et du profil
+// de la ligne (2 bits par colonne et par bordure, 14 colonnes au plus). Une
+// entrée garde les deux premiers mots des tuiles restantes ; les mots
+// suivants, occupés seulement par les orientations de --rotations, ne sont
+// vérifiés que par le hachage, comme le profil.
+// La mémoire est bornée : des seaux de deux entrées, une ligne de cache par
+// seau. La première entrée garde l'état qui a coûté le plus de noeuds à
+// prouver, la seconde reçoit tous les autres (remplacement systématique).
+// La table est partagée sans verrou : chaque entrée est écrite et lue mot par
+// mot en relaxed, et son dernier mot est un contrôle calculé sur les trois
+// autres. Une entrée lue pendant qu'un autre thread l'écrit mélange deux états,
+// son contrôle ne correspond plus et elle est ignorée (méthode de Hyatt).
+class DeadStateTable {
+public:
+    static const int MAX_COLS = 14;
+
+    // Compteurs d'un moteur, ajoutés à la table une seule fois à sa destruction.
+    struct Counters {
+        long long probes;       // états consultés
+        long long hits;         // états trouvés : branche coupée
+        long long stores;       // états prouvés sans issue et enregistrés
+        long long saved;        // noeuds qu'avait coûté la preuve des états trouvés
+
+        Counters() : probes(0), hits(0), stores(0), saved(0) {}
+    };
+
+    // Table d'environ megabytes Mo (arrondie à une puissance de deux de seaux).
+    explicit DeadStateTable(size_t megabytes)
+        : mask(roundDown(megabytes * 1024 * 1024 / sizeof(Bucket)) - 1), buckets(allocate(mask + 1)),
+          probes(0), hits(0), stores(0), saved(0) {}
+
+    bool find(const TileSet& remaining, uint64_t profile, long long& work) const {
+        uint64_t lo = remaining.word(0), hi = remaining.word(1);
+        uint64_t key = hash(remaining, profile);
+        const Bucket& b = buckets[key & mask];
+        for (const Entry& e : b.entries) {
+            uint64_t meta;
+            if (e.read(key, lo, hi, meta) && (meta & PROFILE_MASK) == profile) {
+                work = (long long)(meta >> 32);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void store(const TileSet& remaining, uint64_t profile, long long work) {
+        uint64_t lo = remaining.word(0), hi = remaining.word(1);
+        uint64_t key = hash(remaining, profile);
+        Bucket& b = buckets[key & mask];
+        uint64_t capped = work < 0xffffffffLL ? uint64_t(work) : 0xffffffffull;
+        uint64_t meta = profile | (capped << 32);
+        // Entrée préférée : vide, illisible ou de moindre coût ; sinon la seconde
+        uint64_t kept = b.entries[0].load(3) == 0 ? 0 : b.entries[0].load(2) >> 32;
+        b.entries[kept <= capped ? 0 : 1].write(key, lo, hi, meta);
+    }
+
+    void add(const Counters& c) {
+        probes.fetch_add(c.probes, std::memory_order_relaxed);
+        hits.fetch_add(c.hits, std::memory_order_relaxed);
+        stores.fetch_add(c.stores, std::memory_order_relaxed);
+        saved.fetch_add(c.saved, std::memory_order_relaxed);
+    }
+
+    size_t entries() const {
+        return (mask + 1) * 2;
+    }
+
+    // Ligne de résumé affichée par les solveurs.
+    void display() const {
+        long long p = probes, h = hits;
+        std::cout << "Table des impasses : " << entries() << " entrées, " << p << " consultations, " << h
+                  << " trouvées (" << (p ? 100.0 * double(h) / double(p) : 0) << " %), " << stores
+                  << " enregistrées, " << saved << " noeuds évités (coût des preuves retrouvées)" << std::endl;
+    }
+
+private:
+    static const uint64_t PROFILE_MASK = 0xffffffffull;
+
+    struct Entry {
+        std::atomic<uint64_t> words[4];     // tuiles restantes (2 mots), profil et coût, contrôle
+
+        Entry() {
+            for (int i = 0; i < 4; ++i) {
+                words[i].store(0, std::memory_order_relaxed);
+            }
+        }
+
+        uint64_t load(int i) const {
+            return words[i].load(std::memory_order_relaxed);
+        }
+
+        bool read(uint64_t key, uint64_t lo, uint64_t hi, uint64_t& meta) const {
+            uint64_t w0 = load(0), w1 = load(1), w2 = load(2), w3 = load(3);
+            if (w0 != lo || w1 != hi || w3 != (key ^ mix(w2))) {
+                return false;
+            }
+            meta = w2;
+            return true;
+        }
+
+        void write(uint64_t key, uint64_t lo, uint64_t hi, uint64_t meta) {
+            words[0].store(lo, std::memory_order_relaxed);
+            words[1].store(hi, std::memory_order_relaxed);
+            words[2].store(meta, std::memory_order_relaxed);
+            words[3].store(key ^ mix(meta), std::memory_order_relaxed);
+        }
+    };
+
+    struct Bucket {
+        alignas(64) Entry entries[2];
+    };
+
+    // En C++11, std::allocator ignore l'alignement de Bucket : le tableau est
+    // alloué à la main sur une frontière de ligne de cache.
+    struct FreeBuckets {
+        void operator()(Bucket* p) const {
+            std::free(p);
+        }
+    };
+
+    static Bucket* allocate(size_t count) {
+        void* memory = 0;
+        if (posix_memalign(&memory, alignof(Bucket), count * sizeof(Bucket)) != 0) {
+            throw std::bad_alloc();
+        }
+        Bucket* b = static_cast<Bucket*>(memory);
+        for (size_t i = 0; i < count; ++i) {
+            new (b + i) Bucket();
+        }
+        return b;
+    }
+
+    static uint64_t mix(uint64_t x) {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ull;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebull;
+        return x ^ (x >> 31);
+    }
+
+    static uint64_t hash(const TileSet& remaining, uint64_t profile) {
+        uint64_t h = mix(remaining.word(0)) ^ remaining.word(1);
+        // Mots du haut : vides sans --rotations, le hachage est alors inchangé
+        for (int i = 2; i < TileSet::WORDS; ++i) {
+            if (remaining.word(i)) {
+                h ^= mix(remaining.word(i) + uint64_t(i));
+            }
+        }
+        return mix(mix(h) ^ profile);
+    }
+
+    static size_t roundDown(size_t n) {
+        size_t p = 1;
+        while (p * 2 <= n) {
+            p *= 2;
+        }
+        return p;
+    }
+
+    const size_t mask;
+    std::unique_ptr<Bucket[], FreeBuckets> buckets;
+    std::atomic<long long> probes, hits, stores, saved;
+};
+
+#endif
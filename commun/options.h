@@ -0,0 +1,116 @@
+#ifndef MACMAHON_OPTIONS_H
+#define MACMAHON_OPTIONS_H
+
+#include <cstdlib>
+#include <string>
+
+#include "search.h"
+#include "sink.h"
+
+// Options de ligne de commande communes aux solveurs :
+//   [--count [--output <fichier|-> [--format text|csv|bin]]] [--no-symmetry] [--order row|spiral|mrv]
+//   [--forward-check] [--generic] [--check-interval N] [--progress MS] [--memo MO] [--rotations]
+//   [--dlx] [--join] <filename> [threads]
+struct SolverOptions {
+    std::string filename;
+    int threads;            // 0 : nombre de threads matériels
+    int checkInterval;      // noeuds entre deux vérifications de l'annulation
+    bool count;             // compter toutes les solutions au lieu de s'arrêter à la première
+    bool symmetry;          // n'essayer en (0,0) qu'une tuile par classe de symétrie
+    CellOrder order;        // ordre de remplissage des cases
+    bool forwardCheck;      // couper les branches condamnées dès la pose
+    bool fixedSize;         // moteur spécialisé à la taille du plateau quand il existe
+    std::string output;     // --count : fichier où écrire les solutions ("-" : sortie standard)
+    SolutionFormat format;  // format des solutions écrites
+    int progress;           // millisecondes entre deux rapports de progression, 0 : aucun
+    int memo;               // taille en Mo de la table des états sans issue, 0 : aucune
+    bool rotations;         // les tuiles peuvent tourner d'un quart de tour
+    bool dlx;               // moteur de couverture exacte au lieu du backtracking
+    bool join;              // moteur par jointure de lignes au lieu du backtracking
+
+    SolverOptions()
+        : threads(0), checkInterval(SearchEngine::DEFAULT_CHECK_INTERVAL), count(false), symmetry(true),
+          order(ORDER_ROW_MAJOR), forwardCheck(false), fixedSize(true), format(FORMAT_TEXT), progress(0),
+          memo(0), rotations(false), dlx(false), join(false) {}
+
+    // Symétries de couleurs actives. Les sous-arbres qu'elles sautent ne sont
+    // que comptés : pour écrire toutes les solutions, seules les copies
+    // identiques de tuiles restent éliminées.
+    bool colorSymmetry() const {
+        return symmetry && output.empty();
+    }
+};
+
+// Renvoie false si la ligne de commande est invalide. Le nombre de threads
+// n'est accepté en second argument que si acceptThreads est vrai.
+inline bool parseOptions(int argc, char* argv[], SolverOptions& options, bool acceptThreads) {
+    int positional = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--check-interval" && i + 1 < argc) {
+            options.checkInterval = std::atoi(argv[++i]);
+            if (options.checkInterval < 1) {
+                return false;
+            }
+        } else if (arg == "--progress" && i + 1 < argc) {
+            options.progress = std::atoi(argv[++i]);
+            if (options.progress < 1) {
+                return false;
+            }
+        } else if (arg == "--memo" && i + 1 < argc) {
+            options.memo = std::atoi(argv[++i]);
+            if (options.memo < 1) {
+                return false;
+            }
+        } else if (arg == "--order" && i + 1 < argc) {
+            if (!parseCellOrder(argv[++i], options.order)) {
+                return false;
+            }
+        } else if (arg == "--output" && i + 1 < argc) {
+            options.output = argv[++i];
+        } else if (arg == "--format" && i + 1 < argc) {
+            if (!parseSolutionFormat(argv[++i], options.format)) {
+                return false;
+            }
+        } else if (arg == "--forward-check") {
+            options.forwardCheck = true;
+        } else if (arg == "--generic") {
+            options.fixedSize = false;
+        } else if (arg == "--dlx") {
+            options.dlx = true;
+        } else if (arg == "--join") {
+            options.join = true;
+        } else if (arg == "--rotations") {
+            options.rotations = true;
+        } else if (arg == "--count") {
+            options.count = true;
+        } else if (arg == "--no-symmetry") {
+            options.symmetry = false;
+        } else if (arg.compare(0, 2, "--") == 0) {
+            return false;
+        } else if (positional == 0) {
+            options.filename = arg;
+            ++positional;
+        } else if (positional == 1 && acceptThreads) {
+            options.threads = std::atoi(arg.c_str());
+            ++positional;
+        } else {
+            return false;
+        }
+    }
+    // Seul le comptage énumère les solutions à écrire. Le moteur de
+    // couverture exacte choisit lui-même ses cases et n'a ni vérification en
+    // avant, ni table des états sans issue, ni suivi de progression ; le
+    // moteur par lignes non plus, et il ne fait que compter les solutions
+    // de la partie du bas sans les reconstruire
+    bool engine = options.dlx || options.join;
+    if ((options.dlx && options.join) ||
+        (engine && (options.order != ORDER_ROW_MAJOR || options.forwardCheck || options.memo > 0 ||
+                    options.progress > 0)) ||
+        (options.join && !options.output.empty())) {
+        return false;
+    }
+    return positional > 0 && (options.output.empty() || options.count);
+}
+
+#endif
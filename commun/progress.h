@@ -0,0 +1,120 @@
+#ifndef MACMAHON_PROGRESS_H
+#define MACMAHON_PROGRESS_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Suivi de la progression d'une longue recherche.
+// Chaque worker (ou chaque tâche d'une tuile de départ) écrit dans son propre
+// ProgressSlot ; le moteur y publie ses noeuds et la part explorée de sa
+// tâche tous les N noeuds, au moment où il consulte déjà son jeton
+// d'annulation. Un seul thread écrit dans une case : des lectures et écritures
+// relaxed suffisent, sans instruction atomique verrouillée dans la boucle de
+// recherche. Le ProgressMonitor lit toutes les cases à intervalle régulier et
+// affiche sur la sortie d'erreur le débit, la part de l'arbre terminée et le
+// temps restant estimé.
+// La part de l'arbre est celle de la partition par tuile posée en (0,0) :
+// chaque tuile de départ pèse 1 / N, et la part explorée sous une tuile est
+// estimée d'après les choix déjà épuisés sur ses premières cases.
+
+struct ProgressSlot {
+    alignas(64) std::atomic<long long> nodes;
+    std::atomic<double> done;           // part de l'arbre terminée par les tâches finies
+    std::atomic<double> running;        // part explorée de la tâche en cours
+
+    ProgressSlot() : nodes(0), done(0), running(0) {}
+
+    // Noeuds explorés depuis la publication précédente et part explorée de la tâche en cours.
+    void publish(long long newNodes, double explored) {
+        nodes.store(nodes.load(std::memory_order_relaxed) + newNodes, std::memory_order_relaxed);
+        running.store(explored, std::memory_order_relaxed);
+    }
+
+    // Tâche terminée (ou écartée sans être explorée) : sa part passe dans done.
+    void finish(double share) {
+        done.store(done.load(std::memory_order_relaxed) + share, std::memory_order_relaxed);
+        running.store(0, std::memory_order_relaxed);
+    }
+};
+
+class ProgressMonitor {
+public:
+    // intervalMs <= 0 : aucun rapport, start() ne lance pas de thread.
+    ProgressMonitor(int slotCount, int intervalMs)
+        : slots(slotCount < 1 ? 1 : slotCount), interval(intervalMs), stopping(false) {}
+
+    ~ProgressMonitor() {
+        stop();
+    }
+
+    ProgressSlot& slot(int i) {
+        return slots[i];
+    }
+
+    bool enabled() const {
+        return interval > 0;
+    }
+
+    void start() {
+        if (enabled() && !reporter.joinable()) {
+            startTime = std::chrono::steady_clock::now();
+            reporter = std::thread(&ProgressMonitor::loop, this);
+        }
+    }
+
+    void stop() {
+        if (!reporter.joinable()) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wakeup.notify_one();
+        reporter.join();
+    }
+
+private:
+    void loop() {
+        long long lastNodes = 0;
+        std::chrono::steady_clock::time_point last = startTime;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!wakeup.wait_for(lock, std::chrono::milliseconds(interval), [this] { return stopping; })) {
+            long long nodes = 0;
+            double fraction = 0;
+            for (const ProgressSlot& s : slots) {
+                nodes += s.nodes.load(std::memory_order_relaxed);
+                fraction += s.done.load(std::memory_order_relaxed) + s.running.load(std::memory_order_relaxed);
+            }
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            std::chrono::duration<double> elapsed = now - startTime, step = now - last;
+            fraction = fraction < 0 ? 0 : fraction > 1 ? 1 : fraction;
+            char line[160];
+            int n = std::snprintf(line, sizeof(line), "[%.1f s] %lld noeuds, %.3g noeuds/s, %.2f %% de l'arbre",
+                                  elapsed.count(), nodes, step.count() > 0 ? (nodes - lastNodes) / step.count() : 0,
+                                  fraction * 100);
+            if (fraction > 0) {
+                std::snprintf(line + n, sizeof(line) - n, ", fin estimée dans %.0f s",
+                              elapsed.count() * (1 - fraction) / fraction);
+            }
+            std::fprintf(stderr, "%s\n", line);
+            lastNodes = nodes;
+            last = now;
+        }
+    }
+
+    std::vector<ProgressSlot> slots;
+    int interval;
+    std::chrono::steady_clock::time_point startTime;
+    std::thread reporter;
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    bool stopping;
+};
+
+#endif
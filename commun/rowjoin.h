@@ -0,0 +1,646 @@
+#ifndef MACMAHON_ROWJOIN_H
+#define MACMAHON_ROWJOIN_H
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "macmahon.h"
+#include "index.h"
+#include "cancel.h"
+
+// Table des états d'une partie du plateau : profil de la ligne du bord de la
+// partie et tuiles utilisées, avec le nombre de façons de remplir la partie.
+// Adressage ouvert, sondage linéaire : une entrée n'est jamais retirée.
+class ProfileTable {
+public:
+    struct Entry {
+        uint64_t profile;   // couleurs du bord de la partie, puis bordures gauche et droite
+        TileSet usage;      // tuiles du jeu utilisées (premières copies de chaque type)
+        long long count;    // nombre de façons de remplir la partie
+        int parent;         // témoin : entrée du niveau précédent...
+        int left, right;    // ... et demi-lignes de la ligne ajoutée
+    };
+
+    ProfileTable() : slots(1024, -1) {}
+
+    // Indice de l'état, -1 s'il est absent.
+    int find(uint64_t profile, const TileSet& usage) const {
+        size_t mask = slots.size() - 1;
+        for (size_t i = hash(profile, usage) & mask;; i = (i + 1) & mask) {
+            int e = slots[i];
+            if (e < 0 || (entries[e].profile == profile && entries[e].usage == usage)) {
+                return e;
+            }
+        }
+    }
+
+    // Entrée de l'état, créée à zéro (created vrai) si elle n'existait pas.
+    Entry& insert(uint64_t profile, const TileSet& usage, bool& created) {
+        if ((entries.size() + 1) * 2 > slots.size()) {
+            grow();
+        }
+        size_t mask = slots.size() - 1;
+        size_t i = hash(profile, usage) & mask;
+        for (; slots[i] >= 0; i = (i + 1) & mask) {
+            Entry& e = entries[slots[i]];
+            if (e.profile == profile && e.usage == usage) {
+                created = false;
+                return e;
+            }
+        }
+        slots[i] = int(entries.size());
+        Entry e = {profile, usage, 0, -1, -1, -1};
+        entries.push_back(e);
+        created = true;
+        return entries.back();
+    }
+
+    const Entry& operator[](int e) const {
+        return entries[e];
+    }
+
+    int size() const {
+        return int(entries.size());
+    }
+
+    static uint64_t hash(uint64_t profile, const TileSet& usage) {
+        // Mélange final de MurmurHash3 : les bits de poids faible, qui donnent
+        // la case, dépendent de tous les bits de la clé
+        uint64_t h = usage.word(0) ^ (usage.word(1) * 0x9E3779B97F4A7C15ull) ^ (profile * 0xC2B2AE3D27D4EB4Full) ^
+                     (usage.word(2) * 0x165667B19E3779F9ull) ^ (usage.word(3) * 0x27D4EB2F165667C5ull);
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDull;
+        h ^= h >> 33;
+        h *= 0xC4CEB9FE1A85EC53ull;
+        return h ^ (h >> 33);
+    }
+
+private:
+    void grow() {
+        slots.assign(slots.size() * 2, -1);
+        size_t mask = slots.size() - 1;
+        for (int e = 0; e < int(entries.size()); ++e) {
+            size_t i = hash(entries[e].profile, entries[e].usage) & mask;
+            while (slots[i] >= 0) {
+                i = (i + 1) & mask;
+            }
+            slots[i] = e;
+        }
+    }
+
+    std::vector<Entry> entries;
+    std::vector<int> slots;         // puissance de deux, au moins deux fois plus de cases que d'entrées
+};
+
+// Tables du moteur par lignes (option --join), partagées en lecture par
+// toutes les recherches une fois construites.
+// Le plateau est rempli ligne entière par ligne entière. Une ligne ne dépend
+// de la précédente que par son profil : couleurs du côté commun, case par
+// case, et couleurs des bordures gauche et droite, identiques d'une ligne à
+// l'autre. Les lignes valides sont trop nombreuses pour être stockées au-delà
+// du 6x6 (530 millions de lignes intérieures pour un 7x7) : on énumère des
+// demi-lignes, de part et d'autre de la colonne du milieu, et une ligne est la
+// jointure d'une moitié gauche et d'une moitié droite sur la couleur de leur
+// côté commun et sur des tuiles disjointes. Chaque table de demi-lignes est
+// indexée sur son profil du haut et sur son profil du bas.
+// La bordure supérieure et la bordure inférieure sont des lignes fictives de
+// couleur uniforme : la première ligne est une ligne ordinaire sous un profil
+// uniforme de la couleur de la bordure gauche, la dernière une ligne posée sur
+// un profil uniforme.
+// Les lignes du bas sont jointes à l'avance, de bas en haut, jusqu'au milieu
+// du plateau : chaque niveau de la table des états (ProfileTable) regroupe les
+// parties de même profil du haut et mêmes tuiles, avec leur nombre. Un niveau
+// qui dépasserait la limite d'états n'est pas gardé : la partie du bas a alors
+// moins de lignes. Les lignes du haut sont parcourues en profondeur par
+// RowJoinSearch, et la recherche se termine par une seule consultation de la
+// table : profil de la dernière ligne du haut et complément de ses tuiles.
+// Les tuiles identiques forment un type, comme dans BasicSearchEngine : les
+// demi-lignes n'emploient que la première orientation de chaque type et un
+// ensemble de tuiles utilisées ne contient que les premières copies de chaque
+// type ; seule la jointure de deux ensembles compte les copies.
+class RowTables {
+public:
+    // Profil sur 32 bits : 2 bits par colonne et par bordure.
+    static const int MAX_COLS = 14;
+    static const int MAX_HALF = (MAX_COLS + 1) / 2;
+    static const int DEFAULT_STATE_LIMIT = 1 << 22;
+
+    // Tuiles consécutives d'une ligne, à gauche ou à droite de la coupe.
+    struct HalfRow {
+        uint8_t tiles[MAX_HALF];
+        uint8_t width;
+        uint16_t tops, bottoms;     // 2 bits par colonne
+        uint8_t outer;              // couleur de la bordure du plateau (gauche ou droite)
+        uint8_t middle;             // couleur du côté commun aux deux moitiés
+        uint8_t copies;             // positions des tuiles qui ont des copies identiques
+        TileSet unique;             // tuiles du jeu sans copie qu'elle utilise
+    };
+
+    RowTables(int rows, int cols, const std::vector<MacMahonTile>& tiles, const CompatibilityIndex& index)
+        : rowCount(rows), colCount(cols), leftWidth(cols - cols / 2), rightWidth(cols / 2), tiles(tiles),
+          index(index), parts(2 * tiles.size()), filterShift(63), stateLimit(DEFAULT_STATE_LIMIT) {
+        int pieces = 0;
+        for (int k = 0; k < int(tiles.size()); ++k) {
+            pieces = std::max(pieces, index.pieceOf(k) + 1);
+        }
+        // Copies : tuiles du jeu dont une orientation est identique, rangées sous
+        // la première orientation de la première d'entre elles
+        typeMask.resize(pieces);
+        for (int k = 0; k < int(tiles.size()); ++k) {
+            int first = k;
+            for (int j = 0; j < k; ++j) {
+                if (tiles[j].getBits() == tiles[k].getBits()) {
+                    first = j;
+                    break;
+                }
+            }
+            if (first == k) {
+                representatives.set(k);
+            }
+            typeMask[index.pieceOf(first)].set(index.pieceOf(k));
+        }
+        for (int p = 0; p < pieces; ++p) {
+            if (typeMask[p].count() > 1 && typeMask[p].test(p)) {
+                copyMasks.push_back(typeMask[p]);
+            }
+        }
+        for (int p = 0; p < pieces; ++p) {
+            for (const TileSet& m : copyMasks) {
+                if (m.test(p)) {
+                    typeMask[p] = m;
+                }
+            }
+            if (typeMask[p].empty()) {
+                typeMask[p].set(p);
+            }
+        }
+        allPieces = TileSet::firstN(pieces);
+    }
+
+    // Limite du nombre d'états d'un niveau de la partie du bas.
+    void setStateLimit(int limit) {
+        stateLimit = limit;
+    }
+
+    // Tâches d'énumération des demi-lignes, indépendantes : une par côté et
+    // par première tuile. Elles peuvent tourner en parallèle avant build().
+    int enumerationTasks() const {
+        return int(parts.size());
+    }
+
+    void enumerate(int task) {
+        int side = task / int(tiles.size());
+        int first = task % int(tiles.size());
+        int width = side == 0 ? leftWidth : rightWidth;
+        std::vector<HalfRow>& out = parts[task];
+        if (width == 0) {
+            // Plateau d'une colonne : moitié droite vide, une par couleur de bordure
+            for (int color = 0; color < 4 && first == 0; ++color) {
+                HalfRow h = HalfRow();
+                h.outer = h.middle = uint8_t(color);
+                out.push_back(h);
+            }
+            return;
+        }
+        if (!representatives.test(first)) {
+            return;
+        }
+        HalfRow h = HalfRow();
+        TileSet used;
+        if (take(used, first)) {
+            extend(h, 0, width, side, first, used, out);
+        }
+    }
+
+    // Rassemble les demi-lignes, construit leurs index puis joint les lignes
+    // du bas jusqu'au milieu du plateau.
+    void build() {
+        for (size_t t = 0; t < parts.size(); ++t) {
+            std::vector<HalfRow>& halves = t < tiles.size() ? left : right;
+            halves.insert(halves.end(), parts[t].begin(), parts[t].end());
+            std::vector<HalfRow>().swap(parts[t]);
+        }
+        int leftBits = 2 * leftWidth + 2, rightBits = 2 * rightWidth + 4;
+        leftByTop.build(left, leftBits, [this](const HalfRow& h) { return leftKey(h.tops, h.outer); });
+        leftByBottom.build(left, leftBits, [this](const HalfRow& h) { return leftKey(h.bottoms, h.outer); });
+        rightByTop.build(right, rightBits, [this](const HalfRow& h) { return rightKey(h.tops, h.middle, h.outer); });
+        rightByBottom.build(right, rightBits,
+                            [this](const HalfRow& h) { return rightKey(h.bottoms, h.middle, h.outer); });
+        rightByTopAnyBorder.build(right, rightBits, [this](const HalfRow& h) { return rightKey(h.tops, h.middle, 0); });
+
+        // Niveau 0 : la bordure inférieure seule, pour toutes les couleurs de bordure
+        levels.assign(1, ProfileTable());
+        for (uint64_t bottom = 0; bottom < 4; ++bottom) {
+            for (uint64_t l = 0; l < 4; ++l) {
+                for (uint64_t r = 0; r < 4; ++r) {
+                    bool created;
+                    levels[0].insert(uniform(bottom) | border(l, r), TileSet(), created).count = 1;
+                }
+            }
+        }
+        while (int(levels.size()) - 1 < rowCount / 2) {
+            // Niveau suivant estimé avec la croissance du dernier : on ne
+            // commence pas un niveau qui dépasserait sûrement la limite
+            if (levels.size() >= 2 && double(levels.back().size()) * levels.back().size() /
+                                          levels[levels.size() - 2].size() > stateLimit) {
+                break;
+            }
+            ProfileTable next;
+            const ProfileTable& below = levels.back();
+            bool overflow = false;
+            for (int e = 0; e < below.size() && !overflow; ++e) {
+                const ProfileTable::Entry& from = below[e];
+                overflow = joinRows(BOTTOM, from.profile, from.usage, -1, [&](int l, int r, const TileSet& used) {
+                    bool created;
+                    ProfileTable::Entry& to = next.insert(rowProfile(l, r, TOP), used, created);
+                    if (created) {
+                        to.parent = e;
+                        to.left = l;
+                        to.right = r;
+                    }
+                    to.count += from.count;
+                    return next.size() > stateLimit;
+                });
+            }
+            if (overflow) {
+                break;
+            }
+            levels.push_back(std::move(next));
+        }
+        // Filtre des états du dernier niveau (un bit par état, au moins 16 bits
+        // par état) : la plupart des parties du haut n'ont pas de complément et
+        // sont écartées sans accès à la table
+        const ProfileTable& last = levels.back();
+        for (filterShift = 64 - 10; filterShift > 64 - 27 && (size_t(1) << (64 - filterShift)) < 16 * size_t(last.size());) {
+            --filterShift;
+        }
+        filter.assign((size_t(1) << (64 - filterShift)) / 64, 0);
+        for (int e = 0; e < last.size(); ++e) {
+            size_t bit = ProfileTable::hash(last[e].profile, last[e].usage) >> filterShift;
+            filter[bit / 64] |= 1ull << (bit % 64);
+        }
+    }
+
+    int rows() const {
+        return rowCount;
+    }
+
+    const std::vector<MacMahonTile>& getTiles() const {
+        return tiles;
+    }
+
+    int cols() const {
+        return colCount;
+    }
+
+    // Première ligne de la partie du bas, jointe à l'avance.
+    int splitRow() const {
+        return rowCount - (int(levels.size()) - 1);
+    }
+
+    int leftHalves() const {
+        return int(left.size());
+    }
+
+    int rightHalves() const {
+        return int(right.size());
+    }
+
+    // États du dernier niveau de la partie du bas, consultés par la recherche.
+    int bottomStates() const {
+        return levels.back().size();
+    }
+
+    const ProfileTable& bottomTable() const {
+        return levels.back();
+    }
+
+    // État du bas qui complète une partie du haut : profil de sa dernière
+    // ligne et tuiles restantes. -1 s'il n'y en a pas.
+    int complete(uint64_t profile, const TileSet& used) const {
+        TileSet rest = complement(used);
+        size_t bit = ProfileTable::hash(profile, rest) >> filterShift;
+        if (!((filter[bit / 64] >> (bit % 64)) & 1)) {
+            return -1;
+        }
+        return levels.back().find(profile, rest);
+    }
+
+    // Profil placé au-dessus de la première ligne : bordure supérieure de la
+    // couleur color, qui est aussi celle de la bordure gauche. La bordure
+    // droite n'est fixée que par la première ligne.
+    uint64_t topBorder(int color) const {
+        return uniform(color) | border(color, 0);
+    }
+
+    // Profil du côté side (TOP ou BOTTOM) de la ligne formée de deux moitiés.
+    uint64_t rowProfile(int l, int r, int side) const {
+        const HalfRow& a = left[l];
+        const HalfRow& b = right[r];
+        uint64_t colors = side == TOP ? a.tops | uint64_t(b.tops) << (2 * leftWidth)
+                                      : a.bottoms | uint64_t(b.bottoms) << (2 * leftWidth);
+        return colors | border(a.outer, b.outer);
+    }
+
+    // Lignes dont le profil du côté side (TOP ou BOTTOM) vaut profile et dont
+    // les tuiles sont libres dans used : appelle f(gauche, droite, tuiles
+    // utilisées avec la ligne), et s'arrête dès que f renvoie true. Renvoie
+    // true dans ce cas. Si firstTile est positive, c'est la première ligne :
+    // elle commence par firstTile et sa bordure droite est libre (celle du
+    // profil est ignorée) ; les lignes sont rendues dans l'ordre de leurs
+    // tuiles, de gauche à droite, comme le parcours ligne par ligne.
+    template<class F>
+    bool joinRows(int side, uint64_t profile, const TileSet& used, int firstTile, const F& f) const {
+        const HalfIndex& leftIndex = side == TOP ? leftByTop : leftByBottom;
+        uint64_t colors = profile & ((1ull << (2 * colCount)) - 1);
+        int l = int(profile >> (2 * colCount)) & 3, r = int(profile >> (2 * colCount + 2)) & 3;
+        // Première ligne : moitiés droites de toutes les bordures droites
+        const HalfIndex& rightIndex = firstTile >= 0 ? rightByTopAnyBorder : side == TOP ? rightByTop : rightByBottom;
+        uint64_t rightColors = colors >> (2 * leftWidth);
+        std::pair<int, int> halves = leftIndex.find(leftKey(colors & ((1ull << (2 * leftWidth)) - 1), l));
+        for (int i = halves.first; i < halves.second; ++i) {
+            int a = leftIndex.ids[i];
+            const HalfRow& h = left[a];
+            TileSet withLeft = used;
+            if ((firstTile >= 0 && h.tiles[0] != firstTile) || !take(withLeft, h)) {
+                continue;
+            }
+            std::pair<int, int> matches = rightIndex.find(firstTile >= 0 ? rightKey(rightColors, h.middle, 0)
+                                                                          : rightKey(rightColors, h.middle, r));
+            for (int j = matches.first; j < matches.second; ++j) {
+                int b = rightIndex.ids[j];
+                TileSet withRow = withLeft;
+                if (take(withRow, right[b]) && f(a, b, withRow)) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    // Place la ligne formée de deux moitiés sur la rangée row du plateau.
+    void placeRow(MacMahonBoard& board, int row, int l, int r) const {
+        for (int c = 0; c < leftWidth; ++c) {
+            board.placeTile(row, c, tiles[left[l].tiles[c]]);
+        }
+        for (int c = 0; c < rightWidth; ++c) {
+            board.placeTile(row, leftWidth + c, tiles[right[r].tiles[c]]);
+        }
+    }
+
+    // Place les lignes de la partie du bas de l'état e, depuis splitRow().
+    void placeBottom(MacMahonBoard& board, int e) const {
+        int row = splitRow();
+        for (int level = int(levels.size()) - 1; level > 0; --level, ++row) {
+            const ProfileTable::Entry& entry = levels[level][e];
+            placeRow(board, row, entry.left, entry.right);
+            e = entry.parent;
+        }
+    }
+
+private:
+    // Demi-lignes triées par clé, et début de chaque clé dans cet ordre : la
+    // clé (18 bits au plus) indexe directement le tableau des débuts. Sous une
+    // même clé, les demi-lignes gardent l'ordre d'énumération, c'est-à-dire
+    // l'ordre de leurs tuiles.
+    struct HalfIndex {
+        std::vector<int> ids;
+        std::vector<int> starts;
+
+        template<class Key>
+        void build(const std::vector<HalfRow>& halves, int keyBits, const Key& key) {
+            starts.assign((size_t(1) << keyBits) + 1, 0);
+            for (const HalfRow& h : halves) {
+                ++starts[key(h) + 1];
+            }
+            for (size_t k = 1; k < starts.size(); ++k) {
+                starts[k] += starts[k - 1];
+            }
+            ids.resize(halves.size());
+            std::vector<int> next(starts.begin(), starts.end() - 1);
+            for (int i = 0; i < int(halves.size()); ++i) {
+                ids[next[key(halves[i])]++] = i;
+            }
+        }
+
+        std::pair<int, int> find(uint64_t key) const {
+            return std::make_pair(starts[key], starts[key + 1]);
+        }
+    };
+
+    uint64_t uniform(uint64_t color) const {
+        uint64_t colors = 0;
+        for (int c = 0; c < colCount; ++c) {
+            colors |= color << (2 * c);
+        }
+        return colors;
+    }
+
+    uint64_t border(uint64_t l, uint64_t r) const {
+        return l << (2 * colCount) | r << (2 * colCount + 2);
+    }
+
+    uint64_t leftKey(uint64_t colors, uint64_t outer) const {
+        return colors | outer << (2 * leftWidth);
+    }
+
+    uint64_t rightKey(uint64_t colors, uint64_t middle, uint64_t outer) const {
+        return colors | middle << (2 * rightWidth) | outer << (2 * rightWidth + 2);
+    }
+
+    // Ajoute la tuile à used : la première copie libre de son type.
+    bool take(TileSet& used, int tile) const {
+        TileSet free = typeMask[index.pieceOf(tile)].without(used);
+        if (free.empty()) {
+            return false;
+        }
+        used.set(free.popFirst());
+        return true;
+    }
+
+    // Ajoute les tuiles de la demi-ligne à used, si elles y sont libres :
+    // un seul test pour les tuiles sans copie, une à une pour les autres.
+    bool take(TileSet& used, const HalfRow& h) const {
+        if (!(used & h.unique).empty()) {
+            return false;
+        }
+        used = used | h.unique;
+        for (int c = 0; h.copies >> c; ++c) {
+            if (((h.copies >> c) & 1) && !take(used, h.tiles[c])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Tuiles restantes : le complément de used, ramené aux premières copies de chaque type.
+    TileSet complement(const TileSet& used) const {
+        TileSet rest = allPieces.without(used);
+        for (const TileSet& m : copyMasks) {
+            int n = (rest & m).count();
+            rest = rest.without(m);
+            for (TileSet copies = m; n > 0; --n) {
+                rest.set(copies.popFirst());
+            }
+        }
+        return rest;
+    }
+
+    void extend(HalfRow& h, int pos, int width, int side, int tile, const TileSet& used,
+                std::vector<HalfRow>& out) const {
+        const MacMahonTile& t = tiles[tile];
+        h.tiles[pos] = uint8_t(tile);
+        h.tops = uint16_t(h.tops & ~(3u << (2 * pos))) | uint16_t(t.getColorAt(TOP) << (2 * pos));
+        h.bottoms = uint16_t(h.bottoms & ~(3u << (2 * pos))) | uint16_t(t.getColorAt(BOTTOM) << (2 * pos));
+        if (pos + 1 == width) {
+            HalfRow done = h;
+            done.width = uint8_t(width);
+            done.outer = uint8_t(side == 0 ? tiles[h.tiles[0]].getColorAt(LEFT) : t.getColorAt(RIGHT));
+            done.middle = uint8_t(side == 0 ? t.getColorAt(RIGHT) : tiles[h.tiles[0]].getColorAt(LEFT));
+            done.copies = 0;
+            for (int c = 0; c < width; ++c) {
+                const TileSet& type = typeMask[index.pieceOf(h.tiles[c])];
+                if (type.count() > 1) {
+                    done.copies = uint8_t(done.copies | 1u << c);
+                } else {
+                    done.unique = done.unique | type;
+                }
+            }
+            out.push_back(done);
+            return;
+        }
+        CellConstraint next = {sideMask(LEFT), sideValue(LEFT, t.getColorAt(RIGHT)), false, false};
+        for (TileSet candidates = index.candidates(next) & representatives; !candidates.empty();) {
+            int k = candidates.popFirst();
+            TileSet with = used;
+            if (take(with, k)) {
+                extend(h, pos + 1, width, side, k, with, out);
+            }
+        }
+    }
+
+    int rowCount, colCount;
+    int leftWidth, rightWidth;
+    const std::vector<MacMahonTile>& tiles;
+    const CompatibilityIndex& index;
+    TileSet representatives;        // première orientation de chaque type de tuile
+    std::vector<TileSet> typeMask;  // par tuile du jeu, ses copies identiques (elle comprise)
+    std::vector<TileSet> copyMasks; // types qui ont plusieurs copies
+    TileSet allPieces;
+    std::vector<std::vector<HalfRow> > parts;   // demi-lignes de chaque tâche d'énumération
+    std::vector<HalfRow> left, right;
+    HalfIndex leftByTop, leftByBottom, rightByTop, rightByBottom;
+    HalfIndex rightByTopAnyBorder;      // première ligne, toutes bordures droites confondues
+    std::vector<ProfileTable> levels;   // niveau k : parties du bas de k lignes
+    std::vector<uint64_t> filter;
+    int filterShift;                // un bit du filtre : hachage de l'état décalé de filterShift
+    int stateLimit;
+};
+
+// Recherche sur les lignes du haut, jusqu'à RowTables::splitRow(), pour une
+// tuile posée en (0,0). Un moteur par thread ; les tables sont partagées.
+class RowJoinSearch {
+public:
+    static const int DEFAULT_CHECK_INTERVAL = 1024;
+
+    explicit RowJoinSearch(const RowTables& tables)
+        : tables(tables), board(tables.rows(), tables.cols()), placed(tables.rows()), found(-1), nodes(0),
+          checkInterval(DEFAULT_CHECK_INTERVAL), untilCheck(DEFAULT_CHECK_INTERVAL), token(0), stopped(false),
+          count(0), firstOnly(false) {}
+
+    void setCheckInterval(int interval) {
+        checkInterval = untilCheck = interval < 1 ? 1 : interval;
+    }
+
+    // Nombre de solutions dont la case (0,0) porte startTile, -1 si elle ne
+    // peut pas y être posée.
+    long long countFrom(int startTile, const CancellationToken* cancellation = 0) {
+        const MacMahonTile& corner = tables.getTiles()[startTile];
+        if (corner.getColorAt(LEFT) != corner.getColorAt(TOP)) {
+            return -1;
+        }
+        start(cancellation, false);
+        search(corner, startTile);
+        return count;
+    }
+
+    // Cherche une solution dont la case (0,0) porte startTile.
+    bool solveFrom(int startTile, const CancellationToken* cancellation = 0) {
+        const MacMahonTile& corner = tables.getTiles()[startTile];
+        if (corner.getColorAt(LEFT) != corner.getColorAt(TOP)) {
+            return false;
+        }
+        start(cancellation, true);
+        return search(corner, startTile) && !stopped;
+    }
+
+    // Plateau de la dernière solution trouvée par solveFrom().
+    const MacMahonBoard& getBoard() const {
+        for (int row = 0; row < tables.splitRow(); ++row) {
+            tables.placeRow(board, row, placed[row].first, placed[row].second);
+        }
+        tables.placeBottom(board, found);
+        return board;
+    }
+
+    // Lignes posées dans la partie du haut.
+    long long getNodes() const {
+        return nodes;
+    }
+
+private:
+    void start(const CancellationToken* cancellation, bool first) {
+        token = cancellation;
+        stopped = false;
+        count = 0;
+        found = -1;
+        firstOnly = first;
+    }
+
+    bool search(const MacMahonTile& corner, int startTile) {
+        return descend(0, tables.topBorder(corner.getColorAt(LEFT)), TileSet(), startTile);
+    }
+
+    // Pose la ligne row sous le profil profile ; à la coupe, consulte la
+    // partie du bas. Renvoie true pour arrêter la recherche.
+    bool descend(int row, uint64_t profile, const TileSet& used, int startTile) {
+        if (row == tables.splitRow()) {
+            int e = tables.complete(profile, used);
+            if (e < 0) {
+                return false;
+            }
+            count += tables.bottomTable()[e].count;
+            found = e;
+            return firstOnly;
+        }
+        return tables.joinRows(TOP, profile, used, row == 0 ? startTile : -1,
+                               [&](int l, int r, const TileSet& withRow) {
+            ++nodes;
+            if (--untilCheck == 0) {
+                untilCheck = checkInterval;
+                if (token && token->isCancelled()) {
+                    stopped = true;
+                    return true;
+                }
+            }
+            placed[row] = std::make_pair(l, r);
+            return descend(row + 1, tables.rowProfile(l, r, BOTTOM), withRow, -1);
+        });
+    }
+
+    const RowTables& tables;
+    mutable MacMahonBoard board;
+    std::vector<std::pair<int, int> > placed;   // demi-lignes de chaque ligne du haut
+    int found;                      // état du bas de la dernière solution
+    long long nodes;
+    int checkInterval;
+    int untilCheck;
+    const CancellationToken* token;
+    bool stopped;
+    long long count;
+    bool firstOnly;
+};
+
+#endif
@@ -0,0 +1,847 @@
+#ifndef MACMAHON_SEARCH_H
+#define MACMAHON_SEARCH_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "macmahon.h"
+#include "index.h"
+#include "cancel.h"
+#include "stats.h"
+#include "progress.h"
+#include "memo.h"
+
+// Résultat d'une tranche de recherche.
+enum SearchStatus {
+    SEARCH_FOUND,           // une solution est sur le plateau
+    SEARCH_EXHAUSTED,       // plus aucune solution sous le préfixe
+    SEARCH_INTERRUPTED      // recherche annulée ou budget de noeuds atteint
+};
+
+// Sous-arbre de recherche transmissible d'un thread à l'autre : les tuiles du
+// préfixe (dans l'ordre des cases) et les tuiles à essayer sur la case suivante.
+struct SearchTask {
+    int length;
+    uint8_t prefix[MAX_BOARD_CELLS];
+    TileSet choices;
+    double weight;          // part de l'arbre couverte, pour le suivi de progression
+};
+
+// Ordre de remplissage des cases.
+enum CellOrder {
+    ORDER_ROW_MAJOR,        // ligne par ligne
+    ORDER_SPIRAL,           // bordure d'abord, en spirale depuis le coin (0,0)
+    ORDER_MRV               // case libre ayant le moins de tuiles compatibles
+};
+
+inline const char* cellOrderName(CellOrder order) {
+    switch (order) {
+        case ORDER_SPIRAL:
+            return "spiral";
+        case ORDER_MRV:
+            return "mrv";
+        default:
+            return "row";
+    }
+}
+
+inline bool parseCellOrder(const std::string& name, CellOrder& order) {
+    for (int o = ORDER_ROW_MAJOR; o <= ORDER_MRV; ++o) {
+        if (name == cellOrderName(CellOrder(o))) {
+            order = CellOrder(o);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Moteur de backtracking commun aux trois versions.
+// Le vecteur de tuiles n'est jamais modifié : la disponibilité est suivie par
+// un TileSet et la récursion est remplacée par une pile explicite de taille
+// fixe, si bien que la boucle de recherche n'alloue rien sur le tas.
+// Les tuiles identiques forment un type : seule la première copie restante de
+// chaque type est essayée, si bien que la recherche branche sur les types et
+// leur nombre de copies au lieu d'essayer chaque copie (k! fois le même
+// sous-arbre pour k copies). Les copies sont donc posées dans l'ordre de
+// leurs indices et toute solution trouvée est canonique.
+// En mode --rotations, les indices désignent les orientations de
+// orientTiles : poser une orientation retire toutes celles de la même tuile,
+// et deux tuiles sont des copies si elles ont les mêmes orientations.
+// La contrainte d'une case vient de ses voisins posés, quel que soit leur
+// côté : les cases peuvent donc être remplies dans n'importe quel ordre. Pour
+// un ordre fixe, elle est calculée quand la recherche atteint la case ; pour
+// l'ordre MRV et la vérification en avant, la contrainte et le nombre de
+// tuiles compatibles de chaque case libre sont tenus à jour à chaque pose et
+// restaurés au retour arrière.
+// La case (0,0) est toujours remplie la première, les versions parallèles
+// répartissant le travail selon la tuile qui y est posée.
+// Les paramètres R et C fixent la taille du plateau à la compilation : bornes
+// de boucles constantes et contrainte ligne par ligne calculée sans table de
+// règles (voir dispatchBoardSize). BasicSearchEngine<0, 0>, alias
+// SearchEngine, lit la taille à l'exécution et sert pour toutes les tailles.
+template<int R, int C>
+class BasicSearchEngine {
+public:
+    static const int MAX_CELLS = MAX_BOARD_CELLS;
+    static const int MAX_TILES = TileSet::CAPACITY;   // tuiles, ou orientations avec --rotations
+    // Nombre de noeuds entre deux lectures du jeton d'annulation.
+    static const int DEFAULT_CHECK_INTERVAL = 1024;
+    // Cases, à partir du préfixe, dont les choix servent à estimer la progression.
+    static const int PROGRESS_DEPTH = 4;
+
+    BasicSearchEngine(int rows, int cols, const std::vector<MacMahonTile>& tiles, const CompatibilityIndex& index,
+                      CellOrder order = ORDER_ROW_MAJOR)
+        : board(rows, cols), tiles(tiles), index(index), order(order), propagate(order == ORDER_MRV),
+          cellCount(rows * cols), nodes(0),
+          checkInterval(DEFAULT_CHECK_INTERVAL) {
+        for (int cell = 0; cell < cells() && cell < MAX_CELLS; ++cell) {
+            rowOf[cell] = cell / cols;
+            colOf[cell] = cell % cols;
+            int row = rowOf[cell], col = colOf[cell];
+            neighborOf[cell][LEFT] = col > 0 ? cell - 1 : -1;
+            neighborOf[cell][TOP] = row > 0 ? cell - cols : -1;
+            neighborOf[cell][RIGHT] = col < cols - 1 ? cell + 1 : -1;
+            neighborOf[cell][BOTTOM] = row < rows - 1 ? cell + cols : -1;
+        }
+        if (order == ORDER_SPIRAL) {
+            spiralOrder(rows, cols);
+        } else {
+            for (int cell = 0; cell < cells() && cell < MAX_CELLS; ++cell) {
+                cellAt[cell] = cell;
+            }
+        }
+        if (order != ORDER_MRV) {
+            compilePlan();
+        }
+        // Orientations de chaque tuile du jeu (une seule sans --rotations)
+        int tileCount = int(tiles.size()) < MAX_TILES ? int(tiles.size()) : MAX_TILES;
+        for (int i = 0; i < tileCount; ++i) {
+            for (int j = 0; j < tileCount; ++j) {
+                if (index.pieceOf(j) == index.pieceOf(i)) {
+                    siblings[i].set(j);
+                }
+            }
+        }
+        // Tuiles identiques : une orientation se retrouve dans la copie
+        // suivante de sa tuile, qui devient éligible quand celle-ci est posée
+        for (int i = 0; i < tileCount; ++i) {
+            bool first = true;
+            for (int j = 0; j < tileCount; ++j) {
+                if (tiles[j].getBits() != tiles[i].getBits() || index.pieceOf(j) == index.pieceOf(i)) {
+                    continue;
+                }
+                if (j < i) {
+                    first = false;
+                } else if (nextCopies[i].empty()) {
+                    nextCopies[i] = siblings[j];
+                }
+            }
+            if (first) {
+                firstCopies.set(i);
+            }
+        }
+        reset();
+    }
+
+    ~BasicSearchEngine() {
+        recordSearchStats(stats);
+        if (memo) {
+            memo->add(memoCounters);
+        }
+    }
+
+    void setCheckInterval(int interval) {
+        checkInterval = interval < 1 ? 1 : interval;
+    }
+
+    // Table des états sans issue, partagée entre moteurs. Ne sert qu'en
+    // remplissage ligne par ligne et jusqu'à 14 colonnes ; ignorée sinon.
+    void setDeadStateTable(DeadStateTable* table) {
+        memo = order == ORDER_ROW_MAJOR && cols() <= DeadStateTable::MAX_COLS ? table : 0;
+        for (int d = 0; d < MAX_CELLS; ++d) {
+            foundAt[d] = -1;
+        }
+    }
+
+    // Publie dans slot les noeuds explorés et la part explorée de la tâche,
+    // qui couvre weight de tout l'arbre, à chaque vérification du jeton et à
+    // chaque retour de run(). À épuisement, sa part passe dans les tâches
+    // terminées du slot. À appeler après place() ou load().
+    void setProgress(ProgressSlot* slot, double weight) {
+        progress = slot;
+        taskWeight = weight;
+        publishedNodes = nodes;
+        trackedDepth = slot ? base + PROGRESS_DEPTH : 0;
+    }
+
+    CellOrder getOrder() const {
+        return order;
+    }
+
+    // Dimensions du plateau, constantes quand elles sont fixées à la compilation.
+    int rows() const {
+        return R > 0 ? R : board.rows();
+    }
+
+    int cols() const {
+        return C > 0 ? C : board.cols();
+    }
+
+    int cells() const {
+        return R > 0 ? R * C : cellCount;
+    }
+
+    // Vérification en avant : après chaque pose, la branche est coupée dès
+    // qu'une case libre n'a plus aucune tuile compatible ou qu'une couleur est
+    // demandée sur un côté par plus de cases libres qu'il ne reste de tuiles
+    // l'offrant sur ce côté. Vide le plateau.
+    void setForwardChecking(bool enabled) {
+        reset();
+        forwardChecking = enabled;
+        propagate = enabled || order == ORDER_MRV;
+        reset();
+    }
+
+    // Vide le plateau ; le compteur de noeuds est conservé.
+    void reset() {
+        while (depth > 0) {
+            pop();
+        }
+        remaining = TileSet::firstN(tiles.size());
+        eligible = remaining & firstCopies;
+        depth = 0;
+        base = 0;
+        prefixReported = false;
+        for (int cell = 0; cell < cells() && cell < MAX_CELLS; ++cell) {
+            CellConstraint free = {0, 0, cell == 0, false};
+            constraints[cell] = free;
+            compatible[cell] = &index.candidates(free);
+            filled[cell] = false;
+            available[cell] = (*compatible[cell] & remaining).count();
+        }
+        // Les cases libres ne demandent encore aucune couleur
+        for (int side = LEFT; side <= BOTTOM; ++side) {
+            for (int color = 0; color < 4; ++color) {
+                slack[side][color] = 0;
+            }
+        }
+        deficits = 0;
+        emptyCells = 0;
+        for (int cell = 0; cell < cells() && cell < MAX_CELLS; ++cell) {
+            emptyCells += available[cell] == 0;
+        }
+        for (int i = 0; i < int(tiles.size()) && i < MAX_TILES; ++i) {
+            addSupply(tiles[i], 1);
+        }
+        if (cells() > 0) {
+            stack[0] = currentCandidates() & eligible;
+            levelSize[0] = stack[0].count();
+        }
+        donatedShare = 0;
+        trackedDepth = progress ? PROGRESS_DEPTH : 0;
+    }
+
+    // Pose la tuile sur la prochaine case libre si elle y convient. Les tuiles
+    // ainsi posées forment un préfixe que solve() ne remet jamais en cause.
+    bool place(int tile) {
+        if (depth >= cells() || !eligible.test(tile) ||
+            !currentCandidates().test(tile)) {
+            return false;
+        }
+        push(tile);
+        base = depth;
+        prefixReported = false;
+        if (depth < cells()) {
+            levelSize[depth] = stack[depth].count();
+        }
+        trackedDepth = progress ? base + PROGRESS_DEPTH : 0;
+        return true;
+    }
+
+    // Remplace le plateau par le préfixe de la tâche et limite la case
+    // suivante aux choix de la tâche.
+    bool load(const SearchTask& task) {
+        reset();
+        for (int i = 0; i < task.length; ++i) {
+            if (!place(task.prefix[i])) {
+                return false;
+            }
+        }
+        if (depth < cells()) {
+            stack[depth] = stack[depth] & task.choices;
+            levelSize[depth] = stack[depth].count();
+        }
+        return true;
+    }
+
+    // Cède la moitié des choix restants de la case ouverte la moins profonde,
+    // c'est-à-dire le plus gros sous-arbre encore à explorer. Renvoie false
+    // s'il n'y a rien à céder.
+    bool donate(SearchTask& task) {
+        for (int k = base; k <= depth && k < cells(); ++k) {
+            int n = stack[k].count();
+            if (n == 0 || (k == depth && n == 1)) {
+                continue;
+            }
+            // Les sous-arbres qui contiennent la part cédée ne seront pas épuisés ici
+            for (int j = base; j <= k; ++j) {
+                foundAt[j] = -1;
+            }
+            double share = choiceShare(k) * (n - n / 2);
+            task.weight = taskWeight * share;
+            donatedShare += share;
+            TileSet kept;
+            for (int i = 0; i < n / 2; ++i) {
+                kept.set(stack[k].popFirst());
+            }
+            task.length = k;
+            for (int i = 0; i < k; ++i) {
+                task.prefix[i] = uint8_t(placed[i]);
+            }
+            task.choices = stack[k];
+            stack[k] = kept;
+            return true;
+        }
+        return false;
+    }
+
+    // Cherche la prochaine solution sous le préfixe, en s'arrêtant après
+    // budget noeuds (budget < 0 : sans limite) ou quand le jeton est annulé.
+    // Un nouvel appel reprend la recherche là où elle s'était arrêtée, y
+    // compris après une solution.
+    SearchStatus run(const CancellationToken* token, long long budget) {
+        SearchStatus status = search(token, budget);
+        if (progress) {
+            publishProgress(status == SEARCH_EXHAUSTED);
+        }
+        return status;
+    }
+
+    bool solve(const CancellationToken* token = 0) {
+        return run(token, -1) == SEARCH_FOUND;
+    }
+
+    // Appelle visit(*this) à chaque solution distincte sous le préfixe et
+    // renvoie leur nombre.
+    template<class Visitor>
+    long long forEachSolution(Visitor visit, const CancellationToken* token = 0) {
+        long long count = 0;
+        while (run(token, -1) == SEARCH_FOUND) {
+            visit(*this);
+            ++count;
+        }
+        return count;
+    }
+
+    // Compte les solutions distinctes sous le préfixe.
+    long long countSolutions(const CancellationToken* token = 0) {
+        return forEachSolution([](const BasicSearchEngine&) {}, token);
+    }
+
+    // Tuile posée à l'étape step de la recherche (l'étape 0 est la case (0,0)).
+    int placedTile(int step) const {
+        return placed[step];
+    }
+
+    // Plateau des cases remplies. La recherche ne travaille que sur cellBits :
+    // le plateau n'est reconstruit qu'à la demande, en général pour une solution.
+    const MacMahonBoard& getBoard() const {
+        for (int cell = 0; cell < cells(); ++cell) {
+            board.placeTile(rowOf[cell], colOf[cell], MacMahonTile());
+        }
+        for (int step = 0; step < depth; ++step) {
+            board.placeTile(rowOf[cellAt[step]], colOf[cellAt[step]], tiles[placed[step]]);
+        }
+        return board;
+    }
+
+    long long getNodes() const {
+        return nodes;
+    }
+
+    // Compteurs de l'instrumentation (vides sans MACMAHON_STATS).
+    SearchStats& getStats() {
+        return stats;
+    }
+
+private:
+    SearchStatus search(const CancellationToken* token, long long budget) {
+        if (token && token->isCancelled()) {
+            return SEARCH_INTERRUPTED;
+        }
+        if (depth == cells()) {
+            if (depth == base) {
+                // Le préfixe remplit déjà le plateau : c'est l'unique solution
+                if (prefixReported) {
+                    return SEARCH_EXHAUSTED;
+                }
+                prefixReported = true;
+                ++solutionsFound;
+                return SEARCH_FOUND;
+            }
+            pop();
+        }
+        int untilCheck = checkInterval;
+        for (long long n = 0;;) {
+            if (stack[depth].empty()) {
+                // Plus aucune tuile à essayer ici : on revient à la case précédente
+                if (depth == base) {
+                    return SEARCH_EXHAUSTED;
+                }
+                if (memo && foundAt[depth] == solutionsFound) {
+                    storeDeadState();
+                }
+                stats.backtrack(depth);
+                pop();
+                continue;
+            }
+            push(stack[depth].popFirst());
+            ++nodes;
+            stats.node(depth);
+            if (depth == cells()) {
+                ++solutionsFound;
+                return SEARCH_FOUND;
+            }
+            if (--untilCheck == 0) {
+                untilCheck = checkInterval;
+                if (token && token->isCancelled()) {
+                    return SEARCH_INTERRUPTED;
+                }
+                if (progress) {
+                    publishProgress(false);
+                }
+            }
+            if (budget >= 0 && ++n >= budget) {
+                return SEARCH_INTERRUPTED;
+            }
+        }
+    }
+
+    // Part de la tâche couverte par chaque choix restant à la profondeur k :
+    // produit des inverses du nombre de choix des cases depuis le préfixe.
+    // Au-delà des cases suivies, le nombre de choix initial est inconnu et
+    // estimé par les choix restants plus celui en cours.
+    double choiceShare(int k) const {
+        double share = 1;
+        for (int j = base; j <= k; ++j) {
+            int size = j < trackedDepth ? levelSize[j] : stack[j].count() + (j < depth);
+            share /= size > 0 ? size : 1;
+        }
+        return share;
+    }
+
+    // Part de la tâche déjà explorée, d'après les choix épuisés sur les
+    // PROGRESS_DEPTH premières cases après le préfixe, moins les sous-arbres cédés.
+    double explored() const {
+        double done = 0, share = 1;
+        for (int k = base; k <= depth && k < trackedDepth && k < cells(); ++k) {
+            if (levelSize[k] == 0) {
+                done += share;
+                break;
+            }
+            share /= levelSize[k];
+            done += share * (levelSize[k] - stack[k].count() - (k < depth));
+        }
+        return done - donatedShare;
+    }
+
+    // Publie les noeuds explorés depuis la publication précédente et la part
+    // explorée ; une tâche épuisée passe dans les tâches terminées, une seule fois.
+    void publishProgress(bool exhausted) {
+        progress->publish(nodes - publishedNodes, taskWeight * explored());
+        publishedNodes = nodes;
+        if (exhausted) {
+            progress->finish(taskWeight * explored());
+            taskWeight = 0;
+        }
+    }
+
+    // Tuiles compatibles avec la case courante. Pour un ordre fixe, les
+    // voisins déjà posés sont connus d'avance et leurs règles sont compilées
+    // par compilePlan() : il ne reste qu'à recopier des couleurs dans la clé
+    // de l'index.
+    const TileSet& currentCandidates() const {
+        if (propagate) {
+            return *compatible[cellAt[depth]];
+        }
+        if (R > 0 && order == ORDER_ROW_MAJOR) {
+            return rowMajorCandidates();
+        }
+        int key = planKey[depth];
+        const PlanRule* rules = plan[depth];
+        for (int i = 0; i < planCopies[depth]; ++i) {
+            key |= ((cellBits[rules[i].neighbor] >> (2 * rules[i].from)) & 3u) << (2 * rules[i].to);
+        }
+        for (int i = planCopies[depth]; i < planSize[depth]; ++i) {
+            // Côté déjà fixé par une règle précédente : les couleurs doivent coïncider
+            if (((cellBits[rules[i].neighbor] >> (2 * rules[i].from)) & 3u) != ((key >> (2 * rules[i].to)) & 3u)) {
+                return index.candidatesByKey(CompatibilityIndex::CONFLICT_KEY);
+            }
+        }
+        return index.candidatesByKey(key);
+    }
+
+    // Ligne par ligne sur un plateau de taille fixe : seuls les voisins du
+    // dessus et de gauche sont posés, sans contradiction possible, et les
+    // règles de neighborRules se réduisent à des masques constants.
+    const TileSet& rowMajorCandidates() const {
+        int cell = depth;
+        int row = cell / C, col = cell % C;
+        int key = planKey[cell];
+        if (row > 0) {
+            unsigned above = cellBits[cell - C];
+            key |= ((above >> (2 * BOTTOM)) & 3u) << (2 * TOP);
+            if (col == 0) {
+                key |= above & sideMask(LEFT);
+            }
+            if (col == C - 1) {
+                key |= above & sideMask(RIGHT);
+            }
+        }
+        if (col > 0) {
+            unsigned left = cellBits[cell - 1];
+            key |= (left >> (2 * RIGHT)) & 3u;
+            if (row == 0) {
+                key |= left & sideMask(TOP);
+            }
+            if (row == R - 1) {
+                key |= left & sideMask(BOTTOM);
+            }
+        }
+        return index.candidatesByKey(key);
+    }
+
+    void compilePlan() {
+        int stepOf[MAX_CELLS];
+        for (int step = 0; step < cells() && step < MAX_CELLS; ++step) {
+            stepOf[cellAt[step]] = step;
+        }
+        for (int step = 0; step < cells() && step < MAX_CELLS; ++step) {
+            int cell = cellAt[step];
+            CellConstraint c = {0, 0, cell == 0, false};
+            PlanRule checks[12];
+            int checkCount = 0;
+            planCopies[step] = 0;
+            for (int side = LEFT; side <= BOTTOM; ++side) {
+                int next = neighborOf[cell][side];
+                if (next < 0 || stepOf[next] > step) {
+                    continue;
+                }
+                SideRule rules[3];
+                int n = neighborRules(rows(), cols(), rowOf[cell], colOf[cell], side, rules);
+                for (int i = 0; i < n; ++i) {
+                    PlanRule r = {uint8_t(next), rules[i].from, rules[i].to};
+                    if (c.mask & sideMask(r.to)) {
+                        checks[checkCount++] = r;
+                    } else {
+                        c.mask |= sideMask(r.to);
+                        plan[step][planCopies[step]++] = r;
+                    }
+                }
+            }
+            // Les vérifications passent après toutes les recopies
+            for (int i = 0; i < checkCount; ++i) {
+                plan[step][planCopies[step] + i] = checks[i];
+            }
+            planSize[step] = planCopies[step] + checkCount;
+            c.corner = c.corner && c.mask == 0;
+            planKey[step] = CompatibilityIndex::keyOf(c);
+        }
+    }
+
+    // Bordure d'abord : anneaux successifs parcourus dans le sens horaire à
+    // partir de leur coin supérieur gauche.
+    void spiralOrder(int rows, int cols) {
+        int n = 0;
+        for (int ring = 0; 2 * ring < rows && 2 * ring < cols; ++ring) {
+            int top = ring, left = ring, bottom = rows - 1 - ring, right = cols - 1 - ring;
+            for (int c = left; c <= right; ++c) {
+                cellAt[n++] = top * cols + c;
+            }
+            for (int r = top + 1; r <= bottom; ++r) {
+                cellAt[n++] = r * cols + right;
+            }
+            for (int c = right - 1; bottom > top && c >= left; --c) {
+                cellAt[n++] = bottom * cols + c;
+            }
+            for (int r = bottom - 1; right > left && r > top; --r) {
+                cellAt[n++] = r * cols + left;
+            }
+        }
+    }
+
+    // Case libre ayant le moins de tuiles compatibles parmi celles qui restent
+    // (la première en cas d'égalité). Les cases remplies sont écartées par un
+    // bit de poids fort plutôt que par un branchement.
+    int mostConstrainedCell() const {
+        int best = 0;
+        int bestKey = (int(filled[0]) << 16) | available[0];
+        for (int cell = 1; cell < cells(); ++cell) {
+            int key = (int(filled[cell]) << 16) | available[cell];
+            if (key < bestKey) {
+                bestKey = key;
+                best = cell;
+            }
+        }
+        return best;
+    }
+
+    // Offre et demande de chaque couleur sur chaque côté : slack vaut le
+    // nombre de tuiles restantes qui l'offrent moins le nombre de cases libres
+    // qui l'exigent, deficits le nombre de couples (côté, couleur) négatifs.
+    void adjustSlack(int side, int color, int delta) {
+        int before = slack[side][color] < 0;
+        slack[side][color] += delta;
+        deficits += int(slack[side][color] < 0) - before;
+    }
+
+    void addSupply(const MacMahonTile& tile, int delta) {
+        for (int side = LEFT; side <= BOTTOM; ++side) {
+            adjustSlack(side, tile.getColorAt(side), delta);
+        }
+    }
+
+    void addDemand(const CellConstraint& c, int delta) {
+        for (int side = LEFT; side <= BOTTOM; ++side) {
+            if (c.mask & sideMask(side)) {
+                adjustSlack(side, requiredColor(c, side), -delta);
+            }
+        }
+    }
+
+    // Vrai si la vérification en avant condamne la branche courante.
+    bool deadEnd() const {
+        return deficits > 0 || emptyCells > 0;
+    }
+
+    // Change le nombre de tuiles compatibles d'une case libre en tenant à
+    // jour le nombre de cases libres qui n'en ont plus aucune.
+    void setAvailable(int cell, int count) {
+        emptyCells += int(count == 0) - int(available[cell] == 0);
+        available[cell] = count;
+    }
+
+    // La tuile posée, dans toutes ses orientations, n'est plus disponible
+    // pour les cases qui l'acceptaient, et la contrainte des voisins libres se
+    // resserre. En mode --rotations, l'offre compte chaque orientation des
+    // tuiles restantes : elle majore l'offre réelle et la coupe reste sûre. Le compteur des cases
+    // remplies est mis à jour lui aussi, sans branchement : les poses et
+    // retraits qui suivent s'y annulent, il est donc exact quand la case est
+    // libérée.
+    void updateNeighbors(int cell, int tile) {
+        addDemand(constraints[cell], -1);
+        for (TileSet gone = siblings[tile]; !gone.empty();) {
+            addSupply(tiles[gone.popFirst()], -1);
+        }
+        for (int other = 0; other < cells(); ++other) {
+            int lost = (*compatible[other] & siblings[tile]).count();
+            available[other] -= lost;
+            emptyCells += (lost > 0) & !filled[other] & (available[other] == 0);
+        }
+        for (int side = LEFT; side <= BOTTOM; ++side) {
+            int next = neighborOf[cell][side];
+            if (next >= 0 && !filled[next]) {
+                saved[depth][side] = constraints[next];
+                savedAvailable[depth][side] = available[next];
+                addDemand(constraints[next], -1);
+                // Vu de la case voisine, la tuile est du côté opposé
+                constrainByNeighbor(constraints[next], rows(), cols(), rowOf[next], colOf[next],
+                                    (side + 2) % 4, tiles[tile]);
+                addDemand(constraints[next], 1);
+                compatible[next] = &index.candidates(constraints[next]);
+                setAvailable(next, (*compatible[next] & remaining).count());
+            }
+        }
+    }
+
+    // Annule exactement ce que updateNeighbors() a modifié, en ordre inverse.
+    void restoreNeighbors(int cell, int tile) {
+        for (int side = BOTTOM; side >= LEFT; --side) {
+            int next = neighborOf[cell][side];
+            if (next >= 0 && !filled[next]) {
+                addDemand(constraints[next], -1);
+                constraints[next] = saved[depth][side];
+                addDemand(constraints[next], 1);
+                compatible[next] = &index.candidates(constraints[next]);
+                setAvailable(next, savedAvailable[depth][side]);
+            }
+        }
+        for (int other = 0; other < cells(); ++other) {
+            int regained = (*compatible[other] & siblings[tile]).count();
+            emptyCells -= (regained > 0) & !filled[other] & (available[other] == 0);
+            available[other] += regained;
+        }
+        for (TileSet back = siblings[tile]; !back.empty();) {
+            addSupply(tiles[back.popFirst()], 1);
+        }
+        addDemand(constraints[cell], 1);
+    }
+
+    // Pose la tuile sur la case courante et prépare les choix de la suivante.
+    void push(int tile) {
+        int cell = cellAt[depth];
+        cellBits[cell] = tiles[tile].getBits();
+        remaining = remaining.without(siblings[tile]);
+        eligible = eligible.without(siblings[tile]) | nextCopies[tile];
+        placed[depth] = tile;
+        if (propagate) {
+            filled[cell] = true;
+            updateNeighbors(cell, tile);
+        }
+        ++depth;
+        if (depth < cells()) {
+            if (order == ORDER_MRV) {
+                cellAt[depth] = mostConstrainedCell();
+            }
+            if (forwardChecking && deadEnd()) {
+                stack[depth] = TileSet();
+            } else {
+                stack[depth] = currentCandidates() & eligible;
+            }
+            if (depth < trackedDepth) {
+                levelSize[depth] = stack[depth].count();
+            }
+            if (SearchStats::ENABLED) {
+                recordCandidates();
+            }
+            if (memo && depth % cols() == 0 && depth > base && depth + cols() < cells()) {
+                probeDeadState();
+            }
+        }
+    }
+
+    // Couleurs du bas de la ligne qui vient d'être complétée, 2 bits par
+    // colonne, suivies des couleurs des bordures gauche et droite qu'elle
+    // impose aux lignes suivantes.
+    uint64_t rowProfile() const {
+        int first = depth - cols();
+        uint64_t profile = 0;
+        for (int col = 0; col < cols(); ++col) {
+            profile |= uint64_t((cellBits[first + col] >> (2 * BOTTOM)) & 3u) << (2 * col);
+        }
+        profile |= uint64_t((cellBits[first] >> (2 * LEFT)) & 3u) << (2 * cols());
+        profile |= uint64_t((cellBits[depth - 1] >> (2 * RIGHT)) & 3u) << (2 * cols() + 2);
+        return profile;
+    }
+
+    // Début de ligne : coupe la branche si l'état est déjà prouvé sans issue,
+    // sinon note de quoi reconnaître son épuisement sans solution.
+    void probeDeadState() {
+        long long work;
+        ++memoCounters.probes;
+        if (!stack[depth].empty() && memo->find(remaining, rowProfile(), work)) {
+            ++memoCounters.hits;
+            memoCounters.saved += work;
+            stack[depth] = TileSet();
+            foundAt[depth] = -1;
+            stats.deadEnd(depth, REJECT_MEMO);
+            return;
+        }
+        foundAt[depth] = solutionsFound;
+        nodesAt[depth] = nodes;
+    }
+
+    // Début de ligne épuisé sans aucune solution : l'état est enregistré.
+    void storeDeadState() {
+        ++memoCounters.stores;
+        memo->store(remaining, rowProfile(), nodes - nodesAt[depth]);
+    }
+
+    // Instrumentation : tuiles écartées par la contrainte de la nouvelle case
+    // et, si elle n'en accepte aucune, motif de l'impasse.
+    void recordCandidates() {
+        stats.filter(remaining.count() - stack[depth].count());
+        if (!stack[depth].empty()) {
+            return;
+        }
+        if (forwardChecking && deadEnd()) {
+            stats.deadEnd(depth, emptyCells > 0 ? REJECT_EMPTY_CELL : REJECT_COLOR_DEFICIT);
+            return;
+        }
+        const TileSet& candidates = currentCandidates();
+        if (&candidates == &index.candidatesByKey(CompatibilityIndex::CONFLICT_KEY)) {
+            stats.deadEnd(depth, REJECT_CONFLICT);
+        } else {
+            stats.deadEnd(depth, candidates.empty() ? REJECT_NO_TILE : REJECT_ALL_USED);
+        }
+    }
+
+    void pop() {
+        --depth;
+        int cell = cellAt[depth];
+        int tile = placed[depth];
+        if (propagate) {
+            restoreNeighbors(cell, tile);
+            filled[cell] = false;
+        }
+        remaining = remaining | siblings[tile];
+        eligible = eligible.without(nextCopies[tile]) | siblings[tile];
+    }
+
+    mutable MacMahonBoard board;
+    const std::vector<MacMahonTile>& tiles;
+    const CompatibilityIndex& index;
+    CellOrder order;
+    bool forwardChecking = false;
+    bool propagate;                 // contraintes des cases libres tenues à jour
+    // Ensembles du chemin critique alignés sur 32 octets : un TileSet ne
+    // chevauche jamais deux lignes de cache (le moteur est toujours sur la pile).
+    alignas(32) TileSet remaining;
+    alignas(32) TileSet eligible;   // première copie restante de chaque type
+    TileSet firstCopies;            // première copie de chaque type
+    int cellCount;
+    int depth = 0;                  // nombre de cases remplies
+    int base = 0;                   // longueur du préfixe fixé par place()
+    bool prefixReported = false;    // solution formée par le seul préfixe déjà rendue
+    long long nodes;                // nombre de tuiles posées par run()
+    int checkInterval;
+    ProgressSlot* progress = 0;     // suivi de progression, 0 sans rapport
+    double taskWeight = 1;          // part de tout l'arbre couverte par la tâche
+    double donatedShare = 0;        // part de la tâche cédée par donate()
+    long long publishedNodes = 0;
+    int trackedDepth = 0;           // profondeurs dont levelSize est tenu à jour
+    DeadStateTable* memo = 0;       // états sans issue, 0 sans table
+    DeadStateTable::Counters memoCounters;
+    long long solutionsFound = 0;   // solutions rendues par run(), copies comprises
+    SearchStats stats;              // instrumentation, vide sans MACMAHON_STATS
+    // Indexés par profondeur
+    int cellAt[MAX_CELLS];          // case remplie à chaque profondeur
+    int placed[MAX_CELLS];          // tuile posée à chaque profondeur
+    alignas(32) TileSet stack[MAX_CELLS];   // tuiles restant à essayer à chaque profondeur
+    int levelSize[MAX_CELLS];       // choix de la case à son ouverture, pour la progression
+    long long foundAt[MAX_CELLS];   // début de ligne : solutions déjà rendues à l'ouverture, -1 sinon
+    long long nodesAt[MAX_CELLS];   // début de ligne : noeuds à l'ouverture
+    CellConstraint saved[MAX_CELLS][4];     // voisins avant la pose
+    int savedAvailable[MAX_CELLS][4];
+    // Indexés par case
+    int rowOf[MAX_CELLS];           // ligne et colonne de chaque case, précalculées
+    int colOf[MAX_CELLS];
+    int neighborOf[MAX_CELLS][4];   // case voisine de chaque côté, -1 hors du plateau
+    // Ordre fixe : règles des voisins déjà posés, par profondeur
+    struct PlanRule {
+        uint8_t neighbor;
+        uint8_t from;
+        uint8_t to;
+    };
+    PlanRule plan[MAX_CELLS][12];   // recopies de couleurs, puis vérifications
+    int planCopies[MAX_CELLS];
+    int planSize[MAX_CELLS];
+    int planKey[MAX_CELLS];         // clé de l'index, côtés contraints sans couleur
+    // Ordre MRV et vérification en avant seulement
+    CellConstraint constraints[MAX_CELLS];  // contrainte imposée par les voisins posés
+    const TileSet* compatible[MAX_CELLS];   // tuiles compatibles avec cette contrainte
+    int available[MAX_CELLS];       // tuiles restantes compatibles
+    bool filled[MAX_CELLS];
+    int slack[4][4];                // offre moins demande, par côté et couleur
+    int deficits;
+    int emptyCells;                 // cases libres sans aucune tuile compatible
+    uint8_t cellBits[MAX_CELLS];    // tuile posée sur chaque case remplie
+    // Indexé par tuile
+    alignas(32) TileSet siblings[MAX_TILES];    // orientations de la même tuile du jeu, elle comprise
+    alignas(32) TileSet nextCopies[MAX_TILES];  // orientations de la copie suivante, vide sinon
+};
+
+typedef BasicSearchEngine<0, 0> SearchEngine;
+
+#endif
@@ -0,0 +1,216 @@
+#ifndef MACMAHON_SINK_H
+#define MACMAHON_SINK_H
+
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "macmahon.h"
+
+// Écriture des solutions sans bloquer les threads de recherche.
+// Chaque thread formate ses solutions dans son propre SolutionBuffer et ne
+// passe au SolutionSink que des blocs d'au moins FLUSH_SIZE octets (ou le
+// reste à la fin de sa recherche). Le dépôt d'un bloc se limite à un échange
+// de chaîne sous verrou : seul le thread d'écriture du sink fait des E/S.
+// Formats :
+//   text : comme MacMahonBoard::display, une ligne vide entre deux solutions ;
+//   csv  : une ligne d'en-tête (r0c0, r0c1...), puis une ligne par solution,
+//          chaque case en quatre lettres (gauche, haut, droite, bas) ;
+//   bin  : "MMHS", version (u16), ROWS (u8), COLS (u8), puis ROWS * COLS
+//          octets par solution (une tuile compactée par case, ligne par
+//          ligne) : la k-ième solution commence à l'octet 8 + k * ROWS * COLS.
+
+enum SolutionFormat {
+    FORMAT_TEXT,
+    FORMAT_CSV,
+    FORMAT_BINARY
+};
+
+inline bool parseSolutionFormat(const std::string& name, SolutionFormat& format) {
+    if (name == "text") {
+        format = FORMAT_TEXT;
+    } else if (name == "csv") {
+        format = FORMAT_CSV;
+    } else if (name == "bin") {
+        format = FORMAT_BINARY;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Ajoute la solution à out, au format donné.
+inline void appendSolution(std::string& out, SolutionFormat format, const MacMahonBoard& board) {
+    static const char letters[] = {' ', 'B', 'G', 'R'};
+    switch (format) {
+        case FORMAT_TEXT:
+            board.appendText(out);
+            out += '\n';
+            break;
+        case FORMAT_CSV:
+            for (int row = 0; row < board.rows(); ++row) {
+                for (int col = 0; col < board.cols(); ++col) {
+                    for (int side = LEFT; side <= BOTTOM; ++side) {
+                        out += letters[board.getTileAt(row, col).getColorAt(side)];
+                    }
+                    out += row == board.rows() - 1 && col == board.cols() - 1 ? '\n' : ',';
+                }
+            }
+            break;
+        case FORMAT_BINARY:
+            for (int row = 0; row < board.rows(); ++row) {
+                for (int col = 0; col < board.cols(); ++col) {
+                    out += char(board.getTileAt(row, col).getBits());
+                }
+            }
+            break;
+    }
+}
+
+class SolutionSink {
+public:
+    SolutionSink(int rows, int cols, SolutionFormat format)
+        : rows(rows), cols(cols), format(format), out(0), closing(false), solutions(0) {}
+
+    ~SolutionSink() {
+        close();
+    }
+
+    // Ouvre la sortie ("-" : sortie standard), écrit l'en-tête du format et
+    // démarre le thread d'écriture.
+    bool open(const std::string& filename) {
+        if (filename == "-") {
+            out = &std::cout;
+        } else {
+            file.open(filename, std::ios::binary);
+            if (!file) {
+                return false;
+            }
+            out = &file;
+        }
+        std::string header;
+        if (format == FORMAT_CSV) {
+            for (int cell = 0; cell < rows * cols; ++cell) {
+                header += "r" + std::to_string(cell / cols) + "c" + std::to_string(cell % cols);
+                header += cell == rows * cols - 1 ? '\n' : ',';
+            }
+        } else if (format == FORMAT_BINARY) {
+            header = std::string("MMHS\x01\x00", 6);
+            header += char(rows);
+            header += char(cols);
+        }
+        out->write(header.data(), std::streamsize(header.size()));
+        writer = std::thread([this] { writerLoop(); });
+        return true;
+    }
+
+    SolutionFormat getFormat() const {
+        return format;
+    }
+
+    // Dépose le bloc (le contenu de chunk est pris, chunk est vidé) ; count
+    // est le nombre de solutions qu'il contient.
+    void submit(std::string& chunk, long long count) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back(std::string());
+            queue.back().swap(chunk);
+        }
+        solutions += count;
+        ready.notify_one();
+    }
+
+    // Écrit les blocs restants et arrête le thread d'écriture.
+    void close() {
+        if (!writer.joinable()) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closing = true;
+        }
+        ready.notify_one();
+        writer.join();
+        out->flush();
+    }
+
+    long long getSolutions() const {
+        return solutions;
+    }
+
+private:
+    void writerLoop() {
+        std::vector<std::string> batch;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                ready.wait(lock, [this] { return closing || !queue.empty(); });
+                if (queue.empty()) {
+                    return;
+                }
+                batch.swap(queue);
+            }
+            for (const std::string& chunk : batch) {
+                out->write(chunk.data(), std::streamsize(chunk.size()));
+            }
+            batch.clear();
+        }
+    }
+
+    int rows, cols;
+    SolutionFormat format;
+    std::ofstream file;
+    std::ostream* out;
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::vector<std::string> queue;
+    bool closing;
+    std::thread writer;
+    std::atomic<long long> solutions;
+};
+
+// Tampon de solutions d'un thread ; sans sink, les solutions sont ignorées.
+class SolutionBuffer {
+public:
+    static const size_t FLUSH_SIZE = 1 << 16;
+
+    explicit SolutionBuffer(SolutionSink* sink) : sink(sink), count(0) {}
+
+    ~SolutionBuffer() {
+        flush();
+    }
+
+    bool enabled() const {
+        return sink != 0;
+    }
+
+    void add(const MacMahonBoard& board) {
+        if (!sink) {
+            return;
+        }
+        appendSolution(buffer, sink->getFormat(), board);
+        ++count;
+        if (buffer.size() >= FLUSH_SIZE) {
+            flush();
+        }
+    }
+
+    void flush() {
+        if (sink && count > 0) {
+            sink->submit(buffer, count);
+            count = 0;
+        }
+    }
+
+private:
+    SolutionSink* sink;
+    std::string buffer;
+    long long count;
+};
+
+#endif
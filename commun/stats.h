@@ -0,0 +1,246 @@
+#ifndef MACMAHON_STATS_H
+#define MACMAHON_STATS_H
+
+#include <iostream>
+
+#ifdef MACMAHON_STATS
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#endif
+
+#include "index.h"
+
+// Instrumentation de la recherche, absente par défaut. Compilé avec
+// -DMACMAHON_STATS, chaque moteur compte ses noeuds, ses impasses par motif
+// et ses retours arrière par profondeur, et chaque worker le temps passé à
+// attendre une tâche et à l'exécuter. Les compteurs sont locaux au moteur ou
+// au worker, sans atomique ; ils sont fusionnés par thread une seule fois, à
+// la destruction du moteur ou à la sortie du worker, puis affichés par
+// printSearchStats() à la fin du programme. Sans le drapeau, SearchStats et
+// TaskClock sont vides et leurs appels disparaissent à la compilation.
+// La profondeur d'un noeud est le nombre de tuiles posées.
+
+// Motif pour lequel une case n'a plus aucune tuile à essayer.
+enum RejectReason {
+    REJECT_CONFLICT,        // deux voisins imposent des couleurs différentes au même côté
+    REJECT_NO_TILE,         // aucune tuile du jeu ne satisfait la contrainte de la case
+    REJECT_ALL_USED,        // les tuiles qui la satisfont sont toutes déjà posées
+    REJECT_EMPTY_CELL,      // vérification en avant : une autre case libre n'a plus de tuile
+    REJECT_COLOR_DEFICIT,   // vérification en avant : couleur demandée plus qu'offerte
+    REJECT_MEMO,            // état de début de ligne déjà prouvé sans issue
+    REJECT_COUNT
+};
+
+inline const char* rejectReasonName(RejectReason reason) {
+    static const char* names[REJECT_COUNT] = {
+        "conflit entre voisins", "aucune tuile compatible", "tuiles compatibles déjà posées",
+        "vérification en avant, case vide", "vérification en avant, couleur en déficit",
+        "état déjà prouvé sans issue"
+    };
+    return names[reason];
+}
+
+#ifdef MACMAHON_STATS
+
+struct SearchStats {
+    static const bool ENABLED = true;
+    static const int MAX_DEPTH = MAX_BOARD_CELLS + 1;
+
+    long long nodes;
+    long long filtered;                 // tuiles restantes écartées par la contrainte de la case
+    long long rejects[REJECT_COUNT];
+    long long nodesAt[MAX_DEPTH];
+    long long deadEndsAt[MAX_DEPTH];    // noeuds sans aucune tuile à essayer ensuite
+    long long backtracksAt[MAX_DEPTH];
+    long long tasks;
+    double waitSeconds, runSeconds;
+
+    SearchStats() {
+        std::memset(this, 0, sizeof(*this));
+    }
+
+    void node(int depth) {
+        ++nodes;
+        ++nodesAt[depth];
+    }
+
+    void backtrack(int depth) {
+        ++backtracksAt[depth];
+    }
+
+    void deadEnd(int depth, RejectReason reason) {
+        ++deadEndsAt[depth];
+        ++rejects[reason];
+    }
+
+    void reject(RejectReason reason) {
+        ++rejects[reason];
+    }
+
+    void filter(int count) {
+        filtered += count;
+    }
+
+    void merge(const SearchStats& other) {
+        nodes += other.nodes;
+        filtered += other.filtered;
+        for (int r = 0; r < REJECT_COUNT; ++r) {
+            rejects[r] += other.rejects[r];
+        }
+        for (int d = 0; d < MAX_DEPTH; ++d) {
+            nodesAt[d] += other.nodesAt[d];
+            deadEndsAt[d] += other.deadEndsAt[d];
+            backtracksAt[d] += other.backtracksAt[d];
+        }
+        tasks += other.tasks;
+        waitSeconds += other.waitSeconds;
+        runSeconds += other.runSeconds;
+    }
+};
+
+// Compteurs fusionnés, un jeu par thread dans l'ordre de première apparition.
+class StatsReport {
+public:
+    void add(const SearchStats& stats) {
+        std::lock_guard<std::mutex> lock(mutex);
+        entry().merge(stats);
+    }
+
+    void print(std::ostream& out) {
+        std::lock_guard<std::mutex> lock(mutex);
+        SearchStats total;
+        out << "Instrumentation :" << std::endl;
+        for (size_t i = 0; i < threads.size(); ++i) {
+            const SearchStats& s = threads[i].second;
+            total.merge(s);
+            out << "  thread " << i << " : " << s.nodes << " noeuds";
+            if (s.tasks > 0) {
+                double busy = s.waitSeconds + s.runSeconds;
+                out << ", " << s.tasks << " tâches, attente " << s.waitSeconds << " s, calcul " << s.runSeconds
+                    << " s (" << (busy > 0 ? 100 * s.runSeconds / busy : 0) << " % occupé)";
+            }
+            out << std::endl;
+        }
+        out << "  tuiles écartées par la contrainte : " << total.filtered << " ("
+            << (total.nodes ? double(total.filtered) / double(total.nodes) : 0) << " par noeud)" << std::endl;
+        out << "  impasses et rejets :" << std::endl;
+        for (int r = 0; r < REJECT_COUNT; ++r) {
+            out << "    " << rejectReasonName(RejectReason(r)) << " : " << total.rejects[r] << std::endl;
+        }
+        out << "  profondeur   noeuds   branchement   impasses   retours" << std::endl;
+        for (int d = 0; d < SearchStats::MAX_DEPTH; ++d) {
+            if (total.nodesAt[d] == 0 && total.backtracksAt[d] == 0) {
+                continue;
+            }
+            long long next = d + 1 < SearchStats::MAX_DEPTH ? total.nodesAt[d + 1] : 0;
+            out << "  " << std::setw(10) << d << " " << std::setw(8) << total.nodesAt[d] << " " << std::setw(13)
+                << (total.nodesAt[d] ? double(next) / double(total.nodesAt[d]) : 0) << " " << std::setw(10)
+                << total.deadEndsAt[d] << " " << std::setw(9) << total.backtracksAt[d] << std::endl;
+        }
+    }
+
+private:
+    SearchStats& entry() {
+        std::thread::id id = std::this_thread::get_id();
+        for (auto& t : threads) {
+            if (t.first == id) {
+                return t.second;
+            }
+        }
+        threads.push_back(std::make_pair(id, SearchStats()));
+        return threads.back().second;
+    }
+
+    std::mutex mutex;
+    std::vector<std::pair<std::thread::id, SearchStats>> threads;
+};
+
+inline StatsReport& statsReport() {
+    static StatsReport report;
+    return report;
+}
+
+inline void recordSearchStats(const SearchStats& stats) {
+    statsReport().add(stats);
+}
+
+inline void printSearchStats(std::ostream& out = std::cout) {
+    statsReport().print(out);
+}
+
+// Temps d'un worker, partagé entre l'attente d'une tâche et son exécution ;
+// ajouté aux compteurs de son thread à la destruction.
+class TaskClock {
+public:
+    TaskClock() : state(IDLE), mark(std::chrono::steady_clock::now()) {}
+
+    ~TaskClock() {
+        idle();
+        recordSearchStats(stats);
+    }
+
+    void waiting() {
+        switchTo(WAITING);
+    }
+
+    void running() {
+        switchTo(RUNNING);
+        ++stats.tasks;
+    }
+
+    void idle() {
+        switchTo(IDLE);
+    }
+
+private:
+    enum State { IDLE, WAITING, RUNNING };
+
+    void switchTo(State next) {
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        std::chrono::duration<double> elapsed = now - mark;
+        if (state == WAITING) {
+            stats.waitSeconds += elapsed.count();
+        } else if (state == RUNNING) {
+            stats.runSeconds += elapsed.count();
+        }
+        state = next;
+        mark = now;
+    }
+
+    State state;
+    std::chrono::steady_clock::time_point mark;
+    SearchStats stats;
+};
+
+#else
+
+struct SearchStats {
+    static const bool ENABLED = false;
+
+    void node(int) {}
+    void backtrack(int) {}
+    void deadEnd(int, RejectReason) {}
+    void reject(RejectReason) {}
+    void filter(int) {}
+};
+
+inline void recordSearchStats(const SearchStats&) {}
+
+inline void printSearchStats(std::ostream& = std::cout) {}
+
+class TaskClock {
+public:
+    void waiting() {}
+    void running() {}
+    void idle() {}
+};
+
+#endif
+
+#endif
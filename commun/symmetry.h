@@ -0,0 +1,134 @@
+#ifndef MACMAHON_SYMMETRY_H
+#define MACMAHON_SYMMETRY_H
+
+#include <algorithm>
+#include <vector>
+
+#include "macmahon.h"
+#include "index.h"
+
+// Symétrie candidate du jeu : transposition du plateau (plateaux carrés
+// seulement) suivie d'une permutation des couleurs. Les règles de bordure
+// (côtés du plateau monochromes, haut et gauche de même couleur) sont
+// invariantes par ces transformations ; les rotations et les autres
+// réflexions déplacent le coin (0,0) et ne le sont pas en général.
+struct TileSymmetry {
+    bool transpose;
+    TileColor colorMap[4];
+
+    MacMahonTile apply(const MacMahonTile& tile) const {
+        TileColor left = colorMap[tile.getColorAt(LEFT)];
+        TileColor top = colorMap[tile.getColorAt(TOP)];
+        TileColor right = colorMap[tile.getColorAt(RIGHT)];
+        TileColor bottom = colorMap[tile.getColorAt(BOTTOM)];
+        MacMahonTile t;
+        if (transpose) {
+            t.setColors(top, left, bottom, right);
+        } else {
+            t.setColors(left, top, right, bottom);
+        }
+        return t;
+    }
+};
+
+// Détection des symétries du jeu de tuiles et contrainte de forme canonique.
+// Une symétrie qui laisse le jeu de tuiles inchangé envoie toute solution sur
+// une solution, et elle fixe la case (0,0) : les sous-arbres des tuiles de
+// départ c et s(c) sont donc équivalents. Seule la tuile de plus petit indice
+// parmi ses équivalentes (copies identiques comprises) est essayée en (0,0).
+// Sans symétries (enabled faux), seules les copies identiques sont regroupées,
+// le moteur ne posant jamais une copie avant les précédentes.
+class SymmetryBreaker {
+public:
+    SymmetryBreaker(int rows, int cols, const std::vector<MacMahonTile>& tiles, bool enabled = true)
+        : tiles(tiles), representative(tiles.size()) {
+        for (size_t i = 0; i < tiles.size(); ++i) {
+            representative[i] = firstOfType(tiles[i]);
+        }
+        if (!enabled) {
+            return;
+        }
+        static const TileColor perms[6][3] = {
+            {BLUE, GREEN, RED}, {BLUE, RED, GREEN}, {GREEN, BLUE, RED},
+            {GREEN, RED, BLUE}, {RED, BLUE, GREEN}, {RED, GREEN, BLUE}
+        };
+        for (int transpose = 0; transpose <= (rows == cols ? 1 : 0); ++transpose) {
+            for (int p = 0; p < 6; ++p) {
+                if (!transpose && p == 0) {
+                    continue;   // identité
+                }
+                TileSymmetry s = {transpose != 0, {EMPTY, perms[p][0], perms[p][1], perms[p][2]}};
+                if (preservesTiles(s)) {
+                    symmetries.push_back(s);
+                }
+            }
+        }
+        for (size_t i = 0; i < tiles.size(); ++i) {
+            for (const TileSymmetry& s : symmetries) {
+                representative[i] = std::min(representative[i], firstOfType(s.apply(tiles[i])));
+            }
+        }
+    }
+
+    const std::vector<TileSymmetry>& getSymmetries() const {
+        return symmetries;
+    }
+
+    bool isCanonicalStart(int tile) const {
+        return representative[tile] == tile;
+    }
+
+    // Tuiles à essayer en (0,0).
+    TileSet canonicalStarts() const {
+        TileSet starts;
+        for (int i = 0; i < int(tiles.size()) && i < TileSet::CAPACITY; ++i) {
+            if (isCanonicalStart(i)) {
+                starts.set(i);
+            }
+        }
+        return starts;
+    }
+
+    // Complète les comptes par tuile de départ des sous-arbres non explorés :
+    // un sous-arbre équivalent a autant de solutions que son représentant,
+    // une copie identique n'en a aucune (elles sont comptées sur la première).
+    void completeSubtreeCounts(std::vector<long long>& counts) const {
+        for (size_t i = 0; i < counts.size() && i < tiles.size(); ++i) {
+            if (isCanonicalStart(i) || counts[representative[i]] < 0) {
+                continue;
+            }
+            counts[i] = firstOfType(tiles[i]) == int(i) ? counts[representative[i]] : 0;
+        }
+    }
+
+private:
+    int firstOfType(const MacMahonTile& tile) const {
+        for (size_t i = 0; i < tiles.size(); ++i) {
+            if (tiles[i].getBits() == tile.getBits()) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    // Vrai si la symétrie envoie le multi-ensemble des tuiles sur lui-même.
+    bool preservesTiles(const TileSymmetry& s) const {
+        int count[256] = {0};
+        for (const MacMahonTile& t : tiles) {
+            ++count[t.getBits()];
+            --count[s.apply(t).getBits()];
+        }
+        for (int c : count) {
+            if (c != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const std::vector<MacMahonTile>& tiles;
+    std::vector<TileSymmetry> symmetries;
+    std::vector<int> representative;    // plus petit indice équivalent à chaque tuile
+};
+
+#endif
@@ -0,0 +1,295 @@
+#ifndef MACMAHON_THREADPOOL_H
+#define MACMAHON_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "cancel.h"
+#include "stats.h"
+
+// Pool de threads à file sans verrou.
+// Les tâches sont rangées directement dans les cases d'un anneau borné MPMC
+// (algorithme de D. Vyukov) : pas de std::function, pas de packaged_task ni
+// d'allocation par tâche. Un worker sans travail tourne un moment avant de
+// s'endormir, et le mutex ne sert qu'à endormir et réveiller les workers.
+// Une tâche peut être associée à un jeton d'annulation : une fois le jeton
+// annulé, les workers la retirent de la file sans l'exécuter.
+class ThreadPool {
+public:
+    // Taille maximale d'une tâche (objet appelable et ses captures).
+    static const size_t TASK_SIZE = 48;
+
+    explicit ThreadPool(size_t threads, size_t capacity = 4096)
+        : slots(roundUp(capacity)), slotMask(slots.size() - 1),
+          enqueuePos(0), dequeuePos(0), unfinished(0), sleepers(0), stop(false) {
+        for (size_t i = 0; i < slots.size(); ++i) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        if (threads == 0) {
+            threads = 1;
+        }
+        for (size_t i = 0; i < threads; ++i) {
+            workers.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    ~ThreadPool() {
+        wait();
+        {
+            std::lock_guard<std::mutex> lock(parkMutex);
+            stop = true;
+        }
+        parkCondition.notify_all();
+        for (std::thread &worker: workers)
+            worker.join();
+    }
+
+    size_t size() const {
+        return workers.size();
+    }
+
+    // Ajoute une tâche ; si l'anneau est plein, attend qu'une case se libère.
+    template<class F>
+    void enqueue(F&& f, const CancellationToken* token = 0) {
+        push(std::forward<F>(f), token);
+        wakeOne();
+    }
+
+    // Ajoute count tâches f(0) ... f(count - 1) et ne réveille les workers
+    // qu'une fois, à la fin.
+    template<class F>
+    void enqueueBulk(int count, const F& f, const CancellationToken* token = 0) {
+        for (int i = 0; i < count; ++i) {
+            push(IndexedTask<F>{f, i}, token);
+        }
+        wakeAll();
+    }
+
+    // Attend que toutes les tâches ajoutées soient terminées.
+    void wait() {
+        for (int spins = 0; spins < 1024; ++spins) {
+            if (unfinished.load() == 0) {
+                return;
+            }
+            std::this_thread::yield();
+        }
+        std::unique_lock<std::mutex> lock(parkMutex);
+        doneCondition.wait(lock, [this] { return unfinished.load() == 0; });
+    }
+
+private:
+    typedef std::aligned_storage<TASK_SIZE, alignof(std::max_align_t)>::type Storage;
+
+    struct Slot {
+        std::atomic<size_t> sequence;
+        void (*call)(void*);                // exécute puis détruit la tâche
+        void (*discard)(void*);             // détruit la tâche sans l'exécuter
+        void (*relocate)(void*, void*);     // déplace la tâche d'un stockage à l'autre
+        const CancellationToken* token;
+        Storage storage;
+    };
+
+    // Tâche retirée de l'anneau, dans le stockage local du worker.
+    struct LocalTask {
+        void (*call)(void*);
+        void (*discard)(void*);
+        const CancellationToken* token;
+        Storage storage;
+    };
+
+    template<class F>
+    struct IndexedTask {
+        F f;
+        int i;
+        void operator()() { f(i); }
+    };
+
+    template<class F>
+    static void callTask(void* p) {
+        F& f = *static_cast<F*>(p);
+        f();
+        f.~F();
+    }
+
+    template<class F>
+    static void discardTask(void* p) {
+        static_cast<F*>(p)->~F();
+    }
+
+    template<class F>
+    static void relocateTask(void* from, void* to) {
+        F& f = *static_cast<F*>(from);
+        new (to) F(std::move(f));
+        f.~F();
+    }
+
+    static size_t roundUp(size_t n) {
+        size_t p = 2;
+        while (p < n) {
+            p <<= 1;
+        }
+        return p;
+    }
+
+    template<class F>
+    void push(F&& f, const CancellationToken* token) {
+        typedef typename std::decay<F>::type Task;
+        static_assert(sizeof(Task) <= TASK_SIZE, "tâche trop grande pour le stockage du pool");
+        static_assert(alignof(Task) <= alignof(Storage), "alignement de tâche non supporté");
+        if (stop) {
+            throw std::runtime_error("enqueue on stopped ThreadPool");
+        }
+        unfinished.fetch_add(1);
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots[pos & slotMask];
+            size_t seq = slot.sequence.load(std::memory_order_acquire);
+            intptr_t diff = intptr_t(seq) - intptr_t(pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    new (&slot.storage) Task(std::forward<F>(f));
+                    slot.call = &callTask<Task>;
+                    slot.discard = &discardTask<Task>;
+                    slot.relocate = &relocateTask<Task>;
+                    slot.token = token;
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return;
+                }
+            } else if (diff < 0) {
+                if (currentPool() == this) {
+                    // Anneau plein depuis un worker : attendre bloquerait le
+                    // pool entier, la tâche est exécutée sur place
+                    Task task(std::forward<F>(f));
+                    if (!token || !token->isCancelled()) {
+                        task();
+                    }
+                    finishOne();
+                    return;
+                }
+                // Anneau plein : on réveille les workers pour qu'ils le vident
+                wakeAll();
+                std::this_thread::yield();
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Retire une tâche de l'anneau vers le stockage local du worker.
+    bool pop(LocalTask& local) {
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots[pos & slotMask];
+            size_t seq = slot.sequence.load(std::memory_order_acquire);
+            intptr_t diff = intptr_t(seq) - intptr_t(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.relocate(&slot.storage, &local.storage);
+                    local.call = slot.call;
+                    local.discard = slot.discard;
+                    local.token = slot.token;
+                    slot.sequence.store(pos + slotMask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;   // anneau vide
+            } else {
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Pool dont le thread courant est un worker (0 hors des workers).
+    static ThreadPool*& currentPool() {
+        static thread_local ThreadPool* pool = 0;
+        return pool;
+    }
+
+    bool hasQueued() const {
+        return enqueuePos.load() != dequeuePos.load();
+    }
+
+    // La barrière ordonne la publication de la tâche avant la lecture de
+    // sleepers ; le worker fait l'inverse sous parkMutex avant de dormir.
+    void wakeOne() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleepers.load() > 0) {
+            std::lock_guard<std::mutex> lock(parkMutex);
+            parkCondition.notify_one();
+        }
+    }
+
+    void wakeAll() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleepers.load() > 0) {
+            std::lock_guard<std::mutex> lock(parkMutex);
+            parkCondition.notify_all();
+        }
+    }
+
+    void finishOne() {
+        if (unfinished.fetch_sub(1) == 1) {
+            std::lock_guard<std::mutex> lock(parkMutex);
+            doneCondition.notify_all();
+        }
+    }
+
+    void workerLoop() {
+        currentPool() = this;
+        LocalTask local;
+        TaskClock clock;
+        for (;;) {
+            // Attente active, puis mise en sommeil si rien n'arrive
+            clock.waiting();
+            bool got = false;
+            for (int spins = 0; spins < 256 && !got; ++spins) {
+                got = pop(local);
+                if (!got) {
+                    std::this_thread::yield();
+                }
+            }
+            if (!got) {
+                std::unique_lock<std::mutex> lock(parkMutex);
+                sleepers.fetch_add(1);
+                parkCondition.wait(lock, [this] { return stop || hasQueued(); });
+                sleepers.fetch_sub(1);
+                if (stop && !hasQueued()) {
+                    return;
+                }
+                continue;
+            }
+            if (local.token && local.token->isCancelled()) {
+                local.discard(&local.storage);
+            } else {
+                clock.running();
+                local.call(&local.storage);
+            }
+            clock.idle();
+            finishOne();
+        }
+    }
+
+    std::vector<Slot> slots;
+    const size_t slotMask;
+    alignas(64) std::atomic<size_t> enqueuePos;
+    alignas(64) std::atomic<size_t> dequeuePos;
+    alignas(64) std::atomic<int> unfinished;    // tâches ajoutées et non terminées
+    std::atomic<int> sleepers;                  // workers endormis
+    std::vector<std::thread> workers;
+    std::mutex parkMutex;
+    std::condition_variable parkCondition;
+    std::condition_variable doneCondition;
+    std::atomic_bool stop;
+};
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef MACMAHON_TIMING_H
+#define MACMAHON_TIMING_H
+
+#include <chrono>
+#include <ctime>
+#include <iostream>
+
+// Mesure commune à tous les solveurs : temps réel écoulé (steady_clock) et
+// temps CPU du processus, tous threads confondus. clock() ne donne que le
+// second, qui croît avec le nombre de threads : seul le temps réel permet de
+// comparer une version séquentielle et une version parallèle.
+class Stopwatch {
+public:
+    Stopwatch() {
+        restart();
+    }
+
+    void restart() {
+        wallStart = std::chrono::steady_clock::now();
+        cpuStart = cpuNow();
+    }
+
+    double wallSeconds() const {
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - wallStart;
+        return elapsed.count();
+    }
+
+    double cpuSeconds() const {
+        return cpuNow() - cpuStart;
+    }
+
+private:
+    static double cpuNow() {
+        timespec ts;
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+        return double(ts.tv_sec) + double(ts.tv_nsec) * 1e-9;
+    }
+
+    std::chrono::steady_clock::time_point wallStart;
+    double cpuStart;
+};
+
+// Lignes de fin communes à tous les solveurs, dans le format que lit
+// benchmark/bench_solvers.cpp.
+inline void displaySearchStats(double wallSeconds, double cpuSeconds, long long nodes) {
+    std::cout << "Temps : " << wallSeconds << " s (CPU : " << cpuSeconds << " s)" << std::endl;
+    std::cout << "Noeuds explorés : " << nodes << " (" << (wallSeconds > 0 ? nodes / wallSeconds : 0)
+              << " noeuds/s)" << std::endl;
+}
+
+#endif
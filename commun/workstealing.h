@@ -0,0 +1,278 @@
+#ifndef MACMAHON_WORKSTEALING_H
+#define MACMAHON_WORKSTEALING_H
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "macmahon.h"
+#include "index.h"
+#include "search.h"
+#include "cancel.h"
+#include "symmetry.h"
+#include "sink.h"
+#include "progress.h"
+
+// Recherche parallèle par vol de travail.
+// Chaque worker possède une file de sous-arbres (SearchTask). Il prend ses
+// propres tâches par l'arrière et les voleurs prennent par l'avant, où se
+// trouvent les tâches les moins profondes. Quand des workers sont inactifs,
+// un worker occupé cède la moitié de sa case ouverte la moins profonde : la
+// profondeur de découpage s'adapte donc d'elle-même à la forme de l'arbre au
+// lieu d'être fixée à la case (0,0).
+class WorkStealingSolver {
+public:
+    // Nombre de noeuds explorés entre deux vérifications des workers inactifs.
+    static const long long SLICE = 4096;
+
+    WorkStealingSolver(int rows, int cols, const std::vector<MacMahonTile>& tiles,
+                       const CompatibilityIndex& index, int threads)
+        : rows(rows), cols(cols), tiles(tiles), index(index), threadCount(threads < 1 ? 1 : threads),
+          queues(threadCount), solution(rows, cols), solutionFound(false), pending(0), idle(0),
+          nodes(0), steals(0), checkInterval(SearchEngine::DEFAULT_CHECK_INTERVAL), symmetry(0), sink(0),
+          monitor(0), memo(0) {}
+
+    void setCheckInterval(int interval) {
+        checkInterval = interval;
+    }
+
+    // Mode comptage : toutes les solutions sont énumérées. Chaque worker compte
+    // dans ses propres variables, fusionnées une fois les workers terminés.
+    void setCountMode(bool enabled) {
+        countMode = enabled;
+    }
+
+    // Mode comptage : chaque worker formate aussi ses solutions dans son propre
+    // tampon, remis au sink par blocs.
+    void setSolutionSink(SolutionSink* solutionSink) {
+        sink = solutionSink;
+    }
+
+    // Suivi de progression : une case du moniteur par worker, au moins
+    // autant que de threads. Chaque tâche porte sa part de l'arbre, partagée
+    // par donate() entre le worker qui cède et la tâche cédée.
+    void setProgressMonitor(ProgressMonitor* progressMonitor) {
+        monitor = progressMonitor;
+    }
+
+    // Table des états sans issue, partagée par les moteurs de tous les workers.
+    void setDeadStateTable(DeadStateTable* table) {
+        memo = table;
+    }
+
+    void setCellOrder(CellOrder cellOrder) {
+        order = cellOrder;
+    }
+
+    void setForwardChecking(bool enabled) {
+        forwardChecking = enabled;
+    }
+
+    // Ne pose en (0,0) que les tuiles canoniques du SymmetryBreaker ; en mode
+    // comptage, les sous-arbres sautés sont complétés à partir des autres.
+    void setSymmetryBreaker(const SymmetryBreaker* breaker) {
+        symmetry = breaker;
+    }
+
+    bool solve() {
+        // La tâche racine couvre tout l'arbre ; les autres workers la découpent en la volant
+        SearchTask root;
+        root.length = 0;
+        root.choices = TileSet::firstN(tiles.size());
+        root.weight = 1;
+        if (symmetry) {
+            root.choices = root.choices & symmetry->canonicalStarts();
+        }
+        pending = 1;
+        queues[0].tasks.push_back(root);
+        MacMahonBoard empty(rows, cols);
+        subtreeCounts.assign(tiles.size(), 0);
+        for (size_t i = 0; i < tiles.size(); ++i) {
+            if (!canPlaceTile(empty, 0, 0, tiles[i])) {
+                subtreeCounts[i] = -1;
+            }
+        }
+
+        std::vector<std::thread> workers;
+        for (int i = 0; i < threadCount; ++i) {
+            workers.emplace_back(&WorkStealingSolver::worker, this, i);
+        }
+        for (std::thread& t : workers) {
+            t.join();
+        }
+        if (countMode && symmetry) {
+            symmetry->completeSubtreeCounts(subtreeCounts);
+        }
+        return solutionFound;
+    }
+
+    // Nombre de solutions par tuile posée en (0,0), -1 si elle ne peut pas y être posée.
+    const std::vector<long long>& getSubtreeCounts() const {
+        return subtreeCounts;
+    }
+
+    long long getSolutionCount() const {
+        long long total = 0;
+        for (long long c : subtreeCounts) {
+            total += c > 0 ? c : 0;
+        }
+        return total;
+    }
+
+    const MacMahonBoard& getSolution() const {
+        return solution;
+    }
+
+    long long getNodes() const {
+        return nodes;
+    }
+
+    long long getSteals() const {
+        return steals;
+    }
+
+    // Jeton annulé à la première solution.
+    const CancellationToken& getCancellation() const {
+        return cancellation;
+    }
+
+private:
+    struct WorkerQueue {
+        std::mutex mtx;
+        std::deque<SearchTask> tasks;
+    };
+
+    bool popLocal(int id, SearchTask& task) {
+        WorkerQueue& q = queues[id];
+        std::lock_guard<std::mutex> lock(q.mtx);
+        if (q.tasks.empty()) {
+            return false;
+        }
+        task = q.tasks.back();
+        q.tasks.pop_back();
+        return true;
+    }
+
+    bool steal(int id, SearchTask& task) {
+        for (int k = 1; k < threadCount; ++k) {
+            WorkerQueue& q = queues[(id + k) % threadCount];
+            std::lock_guard<std::mutex> lock(q.mtx);
+            if (!q.tasks.empty()) {
+                task = q.tasks.front();
+                q.tasks.pop_front();
+                ++steals;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Attend une tâche ; renvoie false quand tout l'arbre a été exploré.
+    bool acquire(int id, SearchTask& task) {
+        if (popLocal(id, task) || steal(id, task)) {
+            return true;
+        }
+        idle.fetch_add(1);
+        for (int spins = 0;; ++spins) {
+            if (pending.load() == 0 || cancellation.isCancelled()) {
+                idle.fetch_sub(1);
+                return false;
+            }
+            if (popLocal(id, task) || steal(id, task)) {
+                idle.fetch_sub(1);
+                return true;
+            }
+            if (spins < 64) {
+                std::this_thread::yield();
+            } else {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+        }
+    }
+
+    void worker(int id) {
+        SearchEngine engine(rows, cols, tiles, index, order);
+        engine.setForwardChecking(forwardChecking);
+        engine.setCheckInterval(checkInterval);
+        engine.setDeadStateTable(memo);
+        std::vector<long long> counts(countMode ? tiles.size() : 0, 0);
+        SolutionBuffer buffer(countMode ? sink : 0);
+        SearchTask task;
+        TaskClock clock;
+        clock.waiting();
+        while (acquire(id, task)) {
+            clock.running();
+            engine.load(task);
+            engine.setProgress(monitor ? &monitor->slot(id) : 0, task.weight);
+            for (;;) {
+                SearchStatus status = engine.run(&cancellation, SLICE);
+                if (status == SEARCH_FOUND && countMode) {
+                    ++counts[engine.placedTile(0)];
+                    if (buffer.enabled()) {
+                        buffer.add(engine.getBoard());
+                    }
+                    continue;
+                }
+                if (status == SEARCH_FOUND) {
+                    if (!solutionFound.exchange(true)) {
+                        cancellation.cancel();
+                        std::lock_guard<std::mutex> lock(solutionMutex);
+                        solution = engine.getBoard();
+                    }
+                    break;
+                }
+                if (status == SEARCH_EXHAUSTED || cancellation.isCancelled()) {
+                    break;
+                }
+                // Des workers attendent : on publie le sous-arbre le moins profond
+                if (idle.load(std::memory_order_relaxed) > 0) {
+                    SearchTask shared;
+                    if (engine.donate(shared)) {
+                        pending.fetch_add(1);
+                        std::lock_guard<std::mutex> lock(queues[id].mtx);
+                        queues[id].tasks.push_back(shared);
+                    }
+                }
+            }
+            pending.fetch_sub(1);
+            clock.waiting();
+        }
+        clock.idle();
+        nodes += engine.getNodes();
+        buffer.flush();
+        if (countMode) {
+            std::lock_guard<std::mutex> lock(solutionMutex);
+            for (size_t i = 0; i < counts.size(); ++i) {
+                subtreeCounts[i] += counts[i];
+            }
+        }
+    }
+
+    int rows, cols;
+    const std::vector<MacMahonTile>& tiles;
+    const CompatibilityIndex& index;
+    int threadCount;
+    std::vector<WorkerQueue> queues;
+    MacMahonBoard solution;
+    std::mutex solutionMutex;
+    std::atomic_bool solutionFound;
+    CancellationToken cancellation;
+    std::atomic<int> pending;           // tâches en file ou en cours d'exploration
+    std::atomic<int> idle;              // workers à la recherche d'une tâche
+    std::atomic<long long> nodes;
+    std::atomic<long long> steals;
+    int checkInterval;
+    bool countMode = false;
+    CellOrder order = ORDER_ROW_MAJOR;
+    bool forwardChecking = false;
+    const SymmetryBreaker* symmetry;
+    SolutionSink* sink;
+    ProgressMonitor* monitor;
+    DeadStateTable* memo;
+    std::vector<long long> subtreeCounts;
+};
+
+#endif
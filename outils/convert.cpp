@@ -0,0 +1,177 @@
+// Conversion entre le format texte *_colorv2.txt et le conteneur binaire
+// (commun/container.h) :
+//   convert pack <conteneur> <répertoire|manifeste|->   texte -> binaire
+//   convert unpack <conteneur> <répertoire>             binaire -> texte,
+//                                                       répertoire créé au besoin
+//   convert show <conteneur>                            liste des plateaux,
+//                                                       ou solutions affichées
+//   convert show <solutions.bin>                        solutions écrites par
+//                                                       --output --format bin
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include <string>
+
+#include "../commun/macmahon.h"
+#include "../commun/loader.h"
+#include "../commun/container.h"
+#include "../commun/batch.h"
+#include "../commun/sink.h"
+
+static std::string baseName(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+static int pack(const std::string& output, const std::string& input) {
+    PuzzleSource source;
+    if (!source.open(input)) {
+        std::cerr << "Impossible d'ouvrir " << input << std::endl;
+        return 1;
+    }
+    ContainerWriter writer(CONTAINER_PUZZLES);
+    std::string filename;
+    int rejected = 0;
+    while (source.next(filename)) {
+        int rows = 0, cols = 0;
+        std::vector<MacMahonTile> tiles;
+        LoadResult loaded = loadPuzzle(filename, rows, cols, tiles);
+        if (!loaded.ok()) {
+            std::cerr << describeLoadError(filename, loaded) << std::endl;
+            ++rejected;
+            continue;
+        }
+        writer.addPuzzle(baseName(filename), rows, cols, tiles);
+    }
+    if (!writer.save(output)) {
+        std::cerr << "Impossible d'écrire " << output << std::endl;
+        return 1;
+    }
+    std::cout << writer.size() << " plateaux écrits dans " << output
+              << (rejected ? ", " + std::to_string(rejected) + " fichiers refusés" : std::string()) << std::endl;
+    return rejected ? 1 : 0;
+}
+
+static int unpack(const std::string& input, const std::string& directory) {
+    ContainerReader reader;
+    LoadResult opened = reader.open(input);
+    if (!opened.ok()) {
+        std::cerr << describeLoadError(input, opened) << std::endl;
+        return 1;
+    }
+    if (reader.kind() != CONTAINER_PUZZLES) {
+        std::cerr << input << " : conteneur de solutions, utiliser show" << std::endl;
+        return 1;
+    }
+    if (!makeDirectory(directory)) {
+        std::cerr << "Impossible de créer " << directory << std::endl;
+        return 1;
+    }
+    int failed = 0;
+    for (size_t i = 0; i < reader.size(); ++i) {
+        PuzzleRecord record;
+        LoadResult loaded = reader.puzzle(i, record);
+        if (!loaded.ok()) {
+            std::cerr << describeLoadError(input, loaded) << std::endl;
+            ++failed;
+            continue;
+        }
+        // Plateau sans nom ou au nom inutilisable : numéroté
+        std::string name = record.name;
+        if (name.empty() || name.find('/') != std::string::npos || name[0] == '.') {
+            name = "plateau_" + std::to_string(i) + ".txt";
+        }
+        std::string filename = joinPath(directory, name);
+        if (!savePuzzle(filename, record.rows, record.cols, record.tiles)) {
+            std::cerr << "Impossible d'écrire " << filename << std::endl;
+            ++failed;
+        }
+    }
+    std::cout << reader.size() - failed << " plateaux écrits dans " << directory << std::endl;
+    return failed ? 1 : 0;
+}
+
+// Flux "MMHS" de SolutionSink : en-tête de 8 octets puis ROWS * COLS octets
+// par solution.
+static int showStream(const std::string& input, const MappedFile& file) {
+    const char* p = file.data();
+    int rows = file.size() >= 8 ? uint8_t(p[6]) : 0, cols = file.size() >= 8 ? uint8_t(p[7]) : 0;
+    if (rows == 0 || cols == 0 || p[4] != 1 || p[5] != 0 || (file.size() - 8) % size_t(rows * cols) != 0) {
+        std::cerr << input << " : flux de solutions invalide" << std::endl;
+        return 1;
+    }
+    size_t count = (file.size() - 8) / size_t(rows * cols);
+    std::cout << count << " solution(s) " << rows << "x" << cols << std::endl;
+    MacMahonBoard board(rows, cols);
+    for (size_t i = 0; i < count; ++i) {
+        const char* bits = p + 8 + i * size_t(rows * cols);
+        for (int cell = 0; cell < rows * cols; ++cell) {
+            MacMahonTile tile;
+            uint8_t b = uint8_t(bits[cell]);
+            tile.setColors(TileColor(b & 3), TileColor((b >> 2) & 3), TileColor((b >> 4) & 3), TileColor(b >> 6));
+            board.placeTile(cell / cols, cell % cols, tile);
+        }
+        std::cout << "[" << i << "]" << std::endl;
+        board.display();
+    }
+    return 0;
+}
+
+static int show(const std::string& input) {
+    MappedFile file;
+    if (file.open(input) && file.size() >= 4 && std::memcmp(file.data(), "MMHS", 4) == 0) {
+        return showStream(input, file);
+    }
+    ContainerReader reader;
+    LoadResult opened = reader.open(input);
+    if (!opened.ok()) {
+        std::cerr << describeLoadError(input, opened) << std::endl;
+        return 1;
+    }
+    for (size_t i = 0; i < reader.size(); ++i) {
+        if (reader.kind() == CONTAINER_PUZZLES) {
+            PuzzleRecord record;
+            LoadResult loaded = reader.puzzle(i, record);
+            std::cout << "[" << i << "] ";
+            if (loaded.ok()) {
+                std::cout << record.name << " (" << record.rows << "x" << record.cols << ")" << std::endl;
+            } else {
+                std::cout << loaded.message << std::endl;
+            }
+            continue;
+        }
+        SolutionRecord record;
+        LoadResult loaded = reader.solution(i, record);
+        if (!loaded.ok()) {
+            std::cout << "[" << i << "] " << loaded.message << std::endl;
+            continue;
+        }
+        std::cout << "[" << i << "] plateau " << record.puzzle << " (" << record.rows << "x" << record.cols
+                  << ") : " << record.solutions << " solution(s)" << std::endl;
+        if (!record.board.empty()) {
+            MacMahonBoard board(record.rows, record.cols);
+            for (int cell = 0; cell < record.rows * record.cols; ++cell) {
+                board.placeTile(cell / record.cols, cell % record.cols, record.board[cell]);
+            }
+            board.display();
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    std::string command = argc > 1 ? argv[1] : "";
+    if (command == "pack" && argc == 4) {
+        return pack(argv[2], argv[3]);
+    }
+    if (command == "unpack" && argc == 4) {
+        return unpack(argv[2], argv[3]);
+    }
+    if (command == "show" && argc == 3) {
+        return show(argv[2]);
+    }
+    std::cerr << "Usage: " << argv[0] << " pack <conteneur> <répertoire|manifeste|->" << std::endl
+              << "       " << argv[0] << " unpack <conteneur> <répertoire>" << std::endl
+              << "       " << argv[0] << " show <conteneur|solutions.bin>" << std::endl;
+    return 1;
+}
@@ -0,0 +1,207 @@
+// Générateur de plateaux résolubles : une grille solution aléatoire de
+// ROWS x COLS est tirée, puis ses tuiles sont mélangées et écrites au format
+// lu par loadPuzzle. La bordure suit les règles du jeu : une couleur pour le
+// bord gauche et le bord haut, une pour le bord droit, une pour le bord bas ;
+// chaque côté intérieur est tiré parmi les N premières couleurs (B, G, R).
+//   generate [--seed S] [--colors N] [--unique] [--budget NOEUDS] [--tries K]
+//            [--output FICHIER|-] ROWS COLS
+//   generate ... --corpus RÉPERTOIRE NOMBRE ROWS COLS   (répertoire créé au besoin)
+// Moins de couleurs donne plus de tuiles identiques et plus de solutions ;
+// --unique ne garde que les plateaux à solution unique, vérifiée par une
+// recherche exhaustive limitée à --budget noeuds (un plateau dont la
+// vérification dépasse le budget est rejeté). La preuve d'unicité coûte une
+// énumération complète : quelques millisecondes en 5x5, plus d'une minute
+// dès le 6x6, où le budget rejette donc presque tous les tirages. Le tirage
+// ne dépend que de la graine : mt19937 et un mélange écrit ici, sans les
+// distributions de la bibliothèque standard dont le résultat varie d'une
+// implémentation à l'autre.
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../commun/macmahon.h"
+#include "../commun/index.h"
+#include "../commun/loader.h"
+#include "../commun/search.h"
+
+struct GeneratorOptions {
+    int rows, cols;
+    uint32_t seed;
+    int colors;             // couleurs des côtés, de 1 à 3
+    bool unique;            // n'accepter que les plateaux à solution unique
+    long long budget;       // noeuds de la vérification d'unicité
+    int tries;              // tirages par plateau avant abandon
+};
+
+// Entier dans [0, n).
+static int draw(std::mt19937& rng, int n) {
+    return int(rng() % uint32_t(n));
+}
+
+// Tire une grille solution et renvoie ses tuiles mélangées.
+static std::vector<MacMahonTile> randomPuzzle(std::mt19937& rng, int rows, int cols, int colors) {
+    static const TileColor palette[] = {BLUE, GREEN, RED};
+    TileColor frame = palette[draw(rng, colors)];
+    TileColor right = palette[draw(rng, colors)];
+    TileColor bottom = palette[draw(rng, colors)];
+    // vertical[r][c] : côté gauche de la case (r, c) ; horizontal[r][c] : côté haut
+    std::vector<std::vector<TileColor>> vertical(rows, std::vector<TileColor>(cols + 1));
+    std::vector<std::vector<TileColor>> horizontal(rows + 1, std::vector<TileColor>(cols));
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c <= cols; ++c) {
+            vertical[r][c] = c == 0 ? frame : c == cols ? right : palette[draw(rng, colors)];
+        }
+    }
+    for (int r = 0; r <= rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            horizontal[r][c] = r == 0 ? frame : r == rows ? bottom : palette[draw(rng, colors)];
+        }
+    }
+    std::vector<MacMahonTile> tiles(rows * cols);
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            tiles[r * cols + c].setColors(vertical[r][c], horizontal[r][c], vertical[r][c + 1], horizontal[r + 1][c]);
+        }
+    }
+    // Fisher-Yates : la case (0,0) ne doit pas rester la première tuile du fichier
+    for (int i = int(tiles.size()) - 1; i > 0; --i) {
+        std::swap(tiles[i], tiles[draw(rng, i + 1)]);
+    }
+    return tiles;
+}
+
+// Nombre de solutions distinctes, arrêté à 2 ; -1 si le budget est épuisé avant.
+static int countUpToTwo(int rows, int cols, const std::vector<MacMahonTile>& tiles, long long budget) {
+    CompatibilityIndex index(tiles);
+    // Ligne par ligne : plus de noeuds qu'en MRV, mais l'énumération est la plus rapide
+    SearchEngine engine(rows, cols, tiles, index);
+    SearchTask root;
+    root.length = 0;
+    root.choices = TileSet::firstN(tiles.size());
+    engine.load(root);
+    int found = 0;
+    while (found < 2) {
+        long long left = budget - engine.getNodes();
+        if (left <= 0) {
+            return -1;
+        }
+        SearchStatus status = engine.run(0, left);
+        if (status == SEARCH_EXHAUSTED) {
+            break;
+        }
+        if (status == SEARCH_INTERRUPTED) {
+            return -1;
+        }
+        ++found;
+    }
+    return found;
+}
+
+// Tirages rejetés par --unique, par motif.
+struct Rejections {
+    int multiple;           // plusieurs solutions
+    int overBudget;         // vérification hors budget
+};
+
+// Tire un plateau conforme aux options ; false si aucun tirage n'a convenu.
+static bool generate(std::mt19937& rng, const GeneratorOptions& options, std::vector<MacMahonTile>& tiles,
+                     int& attempts, Rejections& rejected) {
+    rejected = Rejections{0, 0};
+    for (attempts = 1; attempts <= options.tries; ++attempts) {
+        tiles = randomPuzzle(rng, options.rows, options.cols, options.colors);
+        if (!options.unique) {
+            return true;
+        }
+        int solutions = countUpToTwo(options.rows, options.cols, tiles, options.budget);
+        if (solutions == 1) {
+            return true;
+        }
+        ++(solutions < 0 ? rejected.overBudget : rejected.multiple);
+    }
+    return false;
+}
+
+int main(int argc, char* argv[]) {
+    GeneratorOptions options = {0, 0, 1, 3, false, 50000000, 1000};
+    std::string output = "-", corpus;
+    int count = 1;
+    std::vector<int> dimensions;
+    bool valid = true;
+    for (int i = 1; i < argc && valid; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--seed" && i + 1 < argc) {
+            options.seed = uint32_t(std::strtoul(argv[++i], 0, 10));
+        } else if (arg == "--colors" && i + 1 < argc) {
+            options.colors = std::atoi(argv[++i]);
+            valid = options.colors >= 1 && options.colors <= 3;
+        } else if (arg == "--unique") {
+            options.unique = true;
+        } else if (arg == "--budget" && i + 1 < argc) {
+            options.budget = std::atoll(argv[++i]);
+            valid = options.budget > 0;
+        } else if (arg == "--tries" && i + 1 < argc) {
+            options.tries = std::atoi(argv[++i]);
+            valid = options.tries > 0;
+        } else if (arg == "--output" && i + 1 < argc) {
+            output = argv[++i];
+        } else if (arg == "--corpus" && i + 2 < argc) {
+            corpus = argv[++i];
+            count = std::atoi(argv[++i]);
+            valid = count > 0;
+        } else if (arg.compare(0, 2, "--") == 0) {
+            valid = false;
+        } else {
+            dimensions.push_back(std::atoi(arg.c_str()));
+        }
+    }
+    valid = valid && dimensions.size() == 2 && dimensions[0] > 0 && dimensions[1] > 0;
+    if (!valid) {
+        std::cerr << "Usage: " << argv[0] << " [--seed S] [--colors 1-3] [--unique] [--budget NOEUDS] [--tries K]"
+                  << " [--output <fichier|->] ROWS COLS" << std::endl
+                  << "       " << argv[0] << " [options] --corpus <répertoire> NOMBRE ROWS COLS" << std::endl;
+        return 1;
+    }
+    options.rows = dimensions[0];
+    options.cols = dimensions[1];
+    if (options.rows * options.cols > MAX_BOARD_CELLS) {
+        std::cerr << "Plateau " << options.rows << "x" << options.cols << " : plus de " << MAX_BOARD_CELLS
+                  << " tuiles" << std::endl;
+        return 1;
+    }
+
+    if (!corpus.empty() && !makeDirectory(corpus)) {
+        std::cerr << "Impossible de créer " << corpus << std::endl;
+        return 1;
+    }
+
+    std::mt19937 rng(options.seed);
+    std::string prefix = "g" + std::to_string(options.rows) + "x" + std::to_string(options.cols) + "_c" +
+                         std::to_string(options.colors) + (options.unique ? "u" : "") + "_s" +
+                         std::to_string(options.seed) + "_";
+    for (int k = 0; k < count; ++k) {
+        std::vector<MacMahonTile> tiles;
+        int attempts = 0;
+        Rejections rejected;
+        if (!generate(rng, options, tiles, attempts, rejected)) {
+            std::cerr << "Aucun plateau à solution unique en " << options.tries << " tirages ("
+                      << rejected.multiple << " à plusieurs solutions, " << rejected.overBudget
+                      << " hors budget)" << std::endl;
+            return 1;
+        }
+        if (corpus.empty() && output == "-") {
+            std::cout << formatPuzzle(options.rows, options.cols, tiles);
+            continue;
+        }
+        std::string filename = corpus.empty() ? output : joinPath(corpus, prefix + std::to_string(k) + ".txt");
+        if (!savePuzzle(filename, options.rows, options.cols, tiles)) {
+            std::cerr << "Impossible d'écrire " << filename << std::endl;
+            return 1;
+        }
+        std::cerr << filename << (options.unique ? " : solution unique, " + std::to_string(attempts) + " tirage(s)"
+                                                 : std::string()) << std::endl;
+    }
+    return 0;
+}
@@ -1,235 +1,156 @@
 #include <iostream>
-#include <fstream>
 #include <vector>
 #include <thread>       // Pour std::thread
-#include <mutex>        // Pour std::mutex
 #include <atomic>       // Pour std::atomic_bool
+#include <chrono>
+#include <memory>
+#include <functional>   // Pour std::cref
+
+#include "../commun/macmahon.h"
+#include "../commun/index.h"
+#include "../commun/loader.h"
+#include "../commun/search.h"
+#include "../commun/options.h"
+#include "../commun/symmetry.h"
+#include "../commun/sink.h"
+#include "../commun/timing.h"
+#include "../commun/progress.h"
+#include "../commun/memo.h"
+
+int ROWS = 0;
+int COLS = 0;
 
+std::atomic_bool solutionFound(false);  // This will be set to true if a solution is found
+std::atomic<long long> totalNodes(0);   // Somme des noeuds explorés par toutes les tâches
+CancellationToken cancellation;         // Annulé dès la première solution
+int checkInterval = SearchEngine::DEFAULT_CHECK_INTERVAL;
+bool countMode = false;                 // --count : toutes les solutions, par tuile de départ
+CellOrder cellOrder = ORDER_ROW_MAJOR;  // --order : ordre de remplissage des cases
+bool forwardCheck = false;              // --forward-check : vérification en avant
+std::vector<long long> subtreeCounts;   // Une case par tâche, fusionnées à la fin
+SolutionSink* sink = 0;                 // --output : solutions écrites, 0 sinon
+ProgressMonitor* monitor = 0;           // --progress : une case par tuile de départ, 0 sinon
+double startShare = 0;                  // part de l'arbre sous chaque tuile de départ
+DeadStateTable* memo = 0;               // --memo : états sans issue partagés, 0 sinon
 
-int ROWS;
-int COLS;
-clock_t start, end;
-enum TileColor {
-    EMPTY,
-    BLUE,
-    GREEN,
-    RED
-};
-
-class MacMahonTile {
-public:
-    MacMahonTile() : colors{EMPTY, EMPTY, EMPTY, EMPTY} {}
-
-    void setColors(TileColor top, TileColor right, TileColor bottom, TileColor left) {
-        colors[0] = top;
-        colors[1] = right;
-        colors[2] = bottom;
-        colors[3] = left;
-    }
-
-    TileColor getColorAt(int position) const {
-        return colors[position];
-    }
-
-private:
-    TileColor colors[4];
-};
-
-class MacMahonBoard {
-public:
-    MacMahonBoard(int rows, int cols) : ROWS(rows), COLS(cols), board(rows, std::vector<MacMahonTile>(cols)) {}
-
-    void placeTile(int row, int col, const MacMahonTile &tile) {
-        board[row][col] = tile;
-    }
-
-    const MacMahonTile& getTileAt(int row, int col) const {
-        return board[row][col];
-    }
-
-    void display() const {
-        for (int i = 0; i < ROWS; ++i) {
-            for (int j = 0; j < COLS; ++j) {
-                for (int k = 0; k < 4; ++k) {
-                    switch (board[i][j].getColorAt(k)) {
-                        case RED:
-                            std::cout << "R";
-                            break;
-                        case GREEN:
-                            std::cout << "G";
-                            break;
-                        case BLUE:
-                            std::cout << "B";
-                            break;
-                        default:
-                            std::cout << " ";
-                            break;
-                    }
-                }
-                std::cout << "\t";
-            }
-            std::cout << std::endl;
-        }
-    }
-
-private:
-    const int ROWS, COLS;
-    std::vector<std::vector<MacMahonTile>> board;
-};
-
-bool canPlaceTile(MacMahonBoard& board, int row, int col, const MacMahonTile& tile) {
-    // Vérifiez le côté supérieur
-    if(row > 0 && board.getTileAt(row - 1, col).getColorAt(3) != tile.getColorAt(1)) {
-        return false;
-    }
-    // Vérifiez le côté gauche
-    if(col > 0 && board.getTileAt(row, col - 1).getColorAt(2) != tile.getColorAt(0)) {
-        return false;
-    }
-    // Vérifiez le côté gauche du panneau supérieur
-    if(col > 0 && row ==0 && tile.getColorAt(1) != board.getTileAt(row, col - 1).getColorAt(1)) {
-        return false;
-    }
-    // Vérifiez le côté supérieur du tableau de gauche
-    if(row > 0 && col ==0 && tile.getColorAt(0) != board.getTileAt(row - 1, col).getColorAt(0)) {
-        return false;
-    }
-    // Vérifiez le côté droit du panneau supérieur
-    if(col == COLS - 1 && row > 0 && tile.getColorAt(2) != board.getTileAt(row - 1, col).getColorAt(2)) {
-        return false;
-    }
-    // Vérifiez le côté gauche du panneau inférieur
-    if(col > 0 && row == ROWS - 1 && tile.getColorAt(3) != board.getTileAt(row, col - 1).getColorAt(3)) {
-        return false;
-    }
-    //vérifiez le côté gauche et supérieur de la première tuile
-    if (row == 0 && col == 0 && tile.getColorAt(0) != tile.getColorAt(1)) {
-        return false;
-    }
-
-    return true;
-}
 
 
 
-TileColor charToTileColor(char c) {
-    switch (c) {
-        case 'R':
-            return RED;
-        case 'G':
-            return GREEN;
-        case 'B':
-            return BLUE;
-        default:
-            return EMPTY;
+void solveWithThread(const std::vector<MacMahonTile>& tiles, const CompatibilityIndex& index, int startingTileIndex) {
+    if (cancellation.isCancelled()) {
+        return; // Sortez plus tôt si une solution a déjà été trouvée
     }
-}
-
-void readDataFromFile(const std::string& filename, std::vector<MacMahonTile>& tiles) {
-    std::ifstream file(filename);
-    if (!file) {
-        std::cerr << "Impossible d'ouvrir le fichier." << std::endl;
+    // Un thread par tâche : tout son temps est du calcul
+    TaskClock clock;
+    clock.running();
+    // Chaque thread a son propre moteur : plateau, pile et tuiles restantes locaux
+    SearchEngine engine(ROWS, COLS, tiles, index, cellOrder);
+    engine.setCheckInterval(checkInterval);
+    engine.setForwardChecking(forwardCheck);
+    engine.setDeadStateTable(memo);
+    ProgressSlot* progress = monitor ? &monitor->slot(startingTileIndex) : 0;
+    // Placez la tuile initiale sur le plateau, si elle respecte la contrainte du coin
+    if (!engine.place(startingTileIndex)) {
+        if (progress) {
+            progress->finish(startShare);
+        }
         return;
     }
+    engine.setProgress(progress, startShare);
 
-    file >> ROWS >> COLS;
-    tiles.clear(); // Efface les tuiles avant de les remplir à nouveau.
-
-    for (int i = 0; i <= ROWS * COLS; ++i) {
-        char top, right, bottom, left;
-        file >> left >> top >> right >> bottom;
-        MacMahonTile tile;
-        tile.setColors(charToTileColor(left), charToTileColor(top), charToTileColor(right), charToTileColor(bottom));
-        tiles.push_back(tile);
+    if (countMode) {
+        // Chaque tâche compte dans ses propres variables, sans atomique partagé,
+        // et formate ses solutions dans son propre tampon
+        SolutionBuffer buffer(sink);
+        subtreeCounts[startingTileIndex] = engine.forEachSolution([&buffer](const SearchEngine& e) {
+            if (buffer.enabled()) {
+                buffer.add(e.getBoard());
+            }
+        });
+        totalNodes += engine.getNodes() + 1;
+        return;
     }
 
-    file.close();
-}
-
-std::atomic_bool solutionFound(false);  // This will be set to true if a solution is found
-std::mutex mtx;                         // Mutex to synchronize access to shared resources
-
-bool solve(MacMahonBoard& board, int row, int col, std::vector<MacMahonTile>& tiles) {
-    // Vérifiez si une solution a déjà été trouvée
-    if (solutionFound.load()) {
-        return false;
+    // Exécutez la recherche séquentielle sous cette tuile de départ
+    bool found = engine.solve(&cancellation);
+    totalNodes += engine.getNodes() + 1;
+    if (found && !solutionFound.exchange(true)) {
+        // Les autres tâches s'arrêtent à leur prochaine vérification ; une
+        // seule arrive ici, l'affichage se passe donc de verrou
+        cancellation.cancel();
+        engine.getBoard().display();
     }
-    // Si nous arrivons à la fin du tableau, nous avons terminé
-    if(row == ROWS) {
-        // Nous avons atteint la fin du tableau
-        return true; // Toutes les tuiles ont été placées avec succès
+}
+int main(int argc, char* argv[]) {
+    SolverOptions options;
+    // Les moteurs de couverture exacte (--dlx) et de jointure de lignes (--join)
+    // ne sont proposés que par les versions séquentielle et ThreadPool
+    if(!parseOptions(argc, argv, options, false) || options.dlx || options.join) {
+        std::cerr << "Usage: " << argv[0] << " [--count [--output <fichier|-> [--format text|csv|bin]]] [--no-symmetry] [--order row|spiral|mrv] [--forward-check] [--check-interval N] [--progress MS] [--memo MO] [--rotations] <filename>" << std::endl;
+        return 1;
     }
 
+    std::string filename = options.filename;
+    checkInterval = options.checkInterval;
+    countMode = options.count;
+    cellOrder = options.order;
+    forwardCheck = options.forwardCheck;
 
+    std::vector<MacMahonTile> tiles;
+    std::vector<int> pieces;
+    LoadResult loaded = loadPuzzle(filename, ROWS, COLS, tiles, options.rotations);
+    if (loaded.ok() && options.rotations) {
+        // --rotations : les moteurs travaillent sur les orientations des tuiles
+        loaded = orientPuzzle(tiles, pieces);
+    }
+    if (!loaded.ok()) {
+        std::cerr << describeLoadError(filename, loaded) << std::endl;
+        return 1;
+    }
 
-    for(int i = 0; i < tiles.size(); i++) {
-        if(canPlaceTile(board, row, col, tiles[i])) {
-            board.placeTile(row, col, tiles[i]);
-
-            // Supprime la tuile des tuiles disponibles
-            MacMahonTile usedTile = tiles[i];
-            tiles.erase(tiles.begin() + i);
-            int newRow = (col == COLS - 1 )? row + 1 : row;
-            int newCol =( col == COLS - 1 )? 0 : col + 1;
-
-            // Essayez de manière récursive de résoudre la position suivante
-            if(solve(board, newRow, newCol, tiles)) {
-                return true;
-            }
+    CompatibilityIndex index(tiles, pieces);
+    subtreeCounts.assign(tiles.size(), -1);
 
-            // Si nous sommes arrivés ici, le placement était erroné. annuler.
-            tiles.insert(tiles.begin() + i, usedTile);
-            board.placeTile(row, col, MacMahonTile());  // Ajoutez cette ligne pour supprimer la tuile placée.
+    // Une seule tuile de départ par classe de symétrie du jeu
+    SymmetryBreaker symmetry(ROWS, COLS, tiles, options.colorSymmetry());
+    std::vector<int> startingTiles;
+    for (int i = 0; i < int(tiles.size()); i++) {
+        if (symmetry.isCanonicalStart(i)) {
+            startingTiles.push_back(i);
         }
     }
-    return false; // Impossible de placer une tuile à la position actuelle
-}
 
-
-
-void solveWithThread(MacMahonBoard initialBoard, std::vector<MacMahonTile> initialTiles, int startingTileIndex) {
-    if (solutionFound.load()) {
-        return; // Sortez plus tôt si une solution a déjà été trouvée
+    // --output : les solutions énumérées sont écrites par le thread du sink
+    SolutionSink solutionSink(ROWS, COLS, options.format);
+    if (!options.output.empty()) {
+        if (!solutionSink.open(options.output)) {
+            std::cerr << "Impossible d'écrire " << options.output << std::endl;
+            return 1;
+        }
+        sink = &solutionSink;
     }
-    // Utilisez une copie locale du plateau et des tuiles pour chaque thread
-    MacMahonBoard board = initialBoard;
-    std::vector<MacMahonTile> tiles = initialTiles;      // Copie locale des tuiles
-    // Placez la tuile initiale sur le plateau
-    board.placeTile(0, 0, tiles[startingTileIndex]);
-    tiles.erase(tiles.begin() + startingTileIndex);
 
-    // Exécutez la fonction séquentielle ici
-    if (solve(board, 0, 0, tiles) && !solutionFound.exchange(true)) {
-        std::lock_guard<std::mutex> lock(mtx);
-        board.display();
-    }
-}
-int main(int argc, char* argv[]) {
-    if(argc != 2) {
-        std::cerr << "Usage: " << argv[0] << " <filename>" << std::endl;
-        return 1;
+    // --memo : table partagée sans verrou par toutes les tâches
+    std::unique_ptr<DeadStateTable> memoTable;
+    if (options.memo > 0) {
+        memoTable.reset(new DeadStateTable(options.memo));
+        memo = memoTable.get();
     }
 
-    std::string filename = argv[1];
-
-    std::vector<MacMahonTile> tiles;
-    readDataFromFile(filename, tiles);
-
-    if(tiles.size()-1 != ROWS * COLS) {
-        std::cout << "Le nombre de tuiles ne correspond pas à la taille du plateau spécifiée." << std::endl;
-        std::cout << "Nombre de tuiles: " << tiles.size() << std::endl;
-        std::cout << "Taille du plateau: " << ROWS << "x" << COLS << std::endl;
-        return 1;
+    // Temps réel et temps CPU de la recherche seule
+    Stopwatch watch;
+    // --progress : rapport périodique sur la sortie d'erreur
+    ProgressMonitor progressMonitor(int(tiles.size()), options.progress);
+    if (progressMonitor.enabled()) {
+        monitor = &progressMonitor;
+        startShare = 1.0 / startingTiles.size();
+        progressMonitor.start();
     }
 
-    MacMahonBoard board(ROWS, COLS);
-
-    auto start = std::chrono::high_resolution_clock::now();
-
     // Créez des fils de discussion pour chaque position de tuile de départ
     std::vector<std::thread> threads;
-    for (int i = 0; i < tiles.size()-1; i++) {
-    std::thread t(solveWithThread, board, tiles, i);
+    for (int i : startingTiles) {
+    std::thread t(solveWithThread, std::cref(tiles), std::cref(index), i);
     threads.push_back(std::move(t));    
     }
 
@@ -238,15 +159,44 @@ int main(int argc, char* argv[]) {
         t.join();
     }
 
-    auto end = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double> elapsed = end - start;
+    progressMonitor.stop();
+    // Toutes les solutions sont écrites avant le résumé
+    solutionSink.close();
+    double wall = watch.wallSeconds(), cpu = watch.cpuSeconds();
 
-    if (solutionFound) {
+    if (countMode) {
+        symmetry.completeSubtreeCounts(subtreeCounts);
+        long long total = 0;
+        for (long long c : subtreeCounts) {
+            total += c > 0 ? c : 0;
+        }
+        std::cout << "Solutions : " << total << std::endl;
+        if (sink) {
+            std::cout << "Solutions écrites : " << sink->getSolutions() << std::endl;
+        }
+        displaySubtreeCounts(tiles, subtreeCounts);
+    } else if (solutionFound) {
         std::cout << "Solution found." << std::endl;
-        std::cout << "Temps pris : " << elapsed.count() << " secondes" << std::endl;
         std::cout << "Le nombre de threads: " << threads.size() << std::endl;
     } else {
         std::cout << "No solution found." << std::endl;
     }
+    displaySearchStats(wall, cpu, totalNodes);
+    std::cout << "Symétries du jeu : " << symmetry.getSymmetries().size()
+              << ", types de tuiles : " << tileTypes(tiles).size()
+              << ", tuiles de départ : " << startingTiles.size() << std::endl;
+    if (options.rotations) {
+        std::cout << "Rotations : " << tiles.size() << " orientations pour " << ROWS * COLS << " tuiles" << std::endl;
+    }
+    std::cout << "Ordre des cases : " << cellOrderName(cellOrder)
+              << (forwardCheck ? ", vérification en avant" : "") << std::endl;
+    if (memo) {
+        memo->display();
+    }
+    if (solutionFound) {
+        std::chrono::duration<double> stopping = std::chrono::steady_clock::now() - cancellation.cancelledAt();
+        std::cout << "Délai entre la solution et la sortie : " << stopping.count() * 1000 << " ms" << std::endl;
+    }
+    printSearchStats();
     return 0;
 }
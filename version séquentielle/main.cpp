@@ -1,215 +1,251 @@
 #include <iostream>
-#include <fstream>
 #include <vector>
-
-int ROWS;
-int COLS;
-
-enum TileColor {
-    EMPTY,
-    BLUE,
-    GREEN,
-    RED
-};
-
-class MacMahonTile {
-public:
-    MacMahonTile() {
-        colors.resize(4, EMPTY);
-    }
-
-    void setColors(TileColor top, TileColor right, TileColor bottom, TileColor left) {
-        colors[0] = top;
-        colors[1] = right;
-        colors[2] = bottom;
-        colors[3] = left;
-    }
-
-    TileColor getColorAt(int position) const {
-        if (position >= 0 && position < 4) {
-            return colors[position];
-        }
-        return RED;
-    }
-
-private:
-    std::vector<TileColor> colors;
-};
-
-class MacMahonBoard {
-public:
-    MacMahonBoard() : board(ROWS, std::vector<MacMahonTile>(COLS)) {}
-
-    void placeTile(int row, int col, const MacMahonTile &tile) {
-        if (row >= 0 && row < ROWS && col >= 0 && col < COLS) {
-            board[row][col] = tile;
-        }
-    }
-
-    const MacMahonTile& getTileAt(int row, int col) const {
-        return board[row][col];
-    }
-
-    void display() const {
-         for (int i = 0; i < ROWS; ++i) {
-        for (int j = 0; j < COLS; ++j) {
-            // Affichez toutes les couleurs de la tuile (les 4 côtés).
-            for (int k = 0; k < 4; ++k) {
-                //affichage des couleurs de la tuile comme demandé lettre pas chiffre 
-                switch (board[i][j].getColorAt(k)) {
-                    case RED:
-                        std::cout << "R";
-                        break;
-                    case GREEN:
-                        std::cout << "G";
-                        break;
-                    case BLUE:
-                        std::cout << "B";
-                        break;
-                    default:
-                        std::cout << " ";
-                        break;
+#include <chrono>
+#include <memory>
+
+#include "../commun/macmahon.h"
+#include "../commun/index.h"
+#include "../commun/loader.h"
+#include "../commun/search.h"
+#include "../commun/options.h"
+#include "../commun/symmetry.h"
+#include "../commun/dispatch.h"
+#include "../commun/sink.h"
+#include "../commun/timing.h"
+#include "../commun/progress.h"
+#include "../commun/memo.h"
+#include "../commun/dlx.h"
+#include "../commun/rowjoin.h"
+
+int ROWS = 0;
+int COLS = 0;
+
+
+// Recherche avec le moteur de taille R x C (0 x 0 : taille lue à l'exécution)
+template<int R, int C>
+struct SequentialSolver {
+    static void run(const SolverOptions& options, const std::vector<MacMahonTile>& tiles,
+                    const CompatibilityIndex& index, const SymmetryBreaker& symmetry, SolutionSink* sink,
+                    ProgressMonitor& monitor, DeadStateTable* memo, long long& nodes) {
+        ProgressSlot* progress = monitor.enabled() ? &monitor.slot(0) : 0;
+        BasicSearchEngine<R, C> engine(ROWS, COLS, tiles, index, options.order);
+        engine.setForwardChecking(options.forwardCheck);
+        engine.setDeadStateTable(memo);
+        if (options.count) {
+            // Compte toutes les solutions, sous-arbre par sous-arbre de la tuile posée en (0,0)
+            std::vector<long long> perFirstTile(tiles.size(), -1);
+            long long total = 0;
+            SolutionBuffer buffer(sink);
+            int starts = symmetry.canonicalStarts().count();
+            for (int i = 0; i < int(tiles.size()); i++) {
+                engine.reset();
+                if (!symmetry.isCanonicalStart(i)) {
+                    continue;
+                }
+                // Chaque tuile de départ pèse la même part de l'arbre
+                if (!engine.place(i)) {
+                    if (progress) {
+                        progress->finish(1.0 / starts);
+                    }
+                } else {
+                    // La tuile de départ compte pour un noeud, comme dans les solveurs parallèles
+                    ++nodes;
+                    engine.setProgress(progress, 1.0 / starts);
+                    perFirstTile[i] = engine.forEachSolution([&buffer](const BasicSearchEngine<R, C>& e) {
+                        if (buffer.enabled()) {
+                            buffer.add(e.getBoard());
+                        }
+                    });
                 }
             }
-            std::cout << "\t";
+            // Toutes les solutions sont écrites avant le résumé
+            buffer.flush();
+            if (sink) {
+                sink->close();
+            }
+            symmetry.completeSubtreeCounts(perFirstTile);
+            for (long long c : perFirstTile) {
+                total += c > 0 ? c : 0;
+            }
+            std::cout << "Solutions : " << total << std::endl;
+            displaySubtreeCounts(tiles, perFirstTile);
+        } else {
+            SearchTask root;
+            root.length = 0;
+            root.choices = symmetry.canonicalStarts();
+            engine.load(root);
+            engine.setProgress(progress, 1);
+            if (engine.solve()) {
+                std::cout << "Solution found:" << std::endl;
+                engine.getBoard().display();
+            } else {
+                std::cout << "No solution found." << std::endl;
+            }
         }
-        std::cout << std::endl;
+        nodes += engine.getNodes();
     }
-    }
-
-private:
-    std::vector<std::vector<MacMahonTile>> board;
 };
-bool canPlaceTile(MacMahonBoard& board, int row, int col, const MacMahonTile& tile) {
-    // Vérifiez le côté supérieur
-    if(row > 0 && board.getTileAt(row - 1, col).getColorAt(3) != tile.getColorAt(1)) {
-        return false;
-    }
-    // Vérifiez le côté gauche
-    if(col > 0 && board.getTileAt(row, col - 1).getColorAt(2) != tile.getColorAt(0)) {
-        return false;
-    }
-    // Vérifiez le côté gauche du panneau supérieur
-    if(col > 0 && row ==0 && tile.getColorAt(1) != board.getTileAt(row, col - 1).getColorAt(1)) {
-        return false;
-    }
-    // Vérifiez le côté supérieur du tableau de gauche
-    if(row > 0 && col ==0 && tile.getColorAt(0) != board.getTileAt(row - 1, col).getColorAt(0)) {
-        return false;
-    }
-    // Vérifiez le côté droit du panneau supérieur
-    if(col == COLS - 1 && row > 0 && tile.getColorAt(2) != board.getTileAt(row - 1, col).getColorAt(2)) {
-        return false;
-    }
-    // Vérifiez le côté gauche du panneau inférieur
-    if(col > 0 && row == ROWS - 1 && tile.getColorAt(3) != board.getTileAt(row, col - 1).getColorAt(3)) {
-        return false;
-    }
-    //vérifiez le côté gauche et supérieur de la première tuile
-    if (row == 0 && col == 0 && tile.getColorAt(0) != tile.getColorAt(1)) {
-        return false;
-    }
-
-    return true;
-}
-
 
-
-TileColor charToTileColor(char c) {
-    switch (c) {
-        case 'R':
-            return RED;
-        case 'G':
-            return GREEN;
-        case 'B':
-            return BLUE;
-        default:
-            return EMPTY;
-    }
-}
-
-void readDataFromFile(const std::string& filename, std::vector<MacMahonTile>& tiles) {
-    std::ifstream file(filename);
-    if (!file) {
-        std::cerr << "Impossible d'ouvrir le fichier." << std::endl;
-        return;
-    }
-
-    file >> ROWS >> COLS;
-    tiles.clear(); // Efface les tuiles avant de les remplir à nouveau.
-
-    for (int i = 0; i <= ROWS * COLS; ++i) {
-        char top, right, bottom, left;
-        file >> left >> top >> right >> bottom;
-        MacMahonTile tile;
-        tile.setColors(charToTileColor(left), charToTileColor(top), charToTileColor(right), charToTileColor(bottom));
-        tiles.push_back(tile);
+// --dlx : même recherche et même sortie avec le moteur de couverture exacte.
+// Il compte toutes les solutions lui-même, sans passer par les symétries.
+static void runDancingLinks(const SolverOptions& options, const std::vector<MacMahonTile>& tiles,
+                            const CompatibilityIndex& index, SolutionSink* sink, long long& nodes) {
+    DancingLinks dlx(ROWS, COLS, tiles, index);
+    if (options.count) {
+        std::vector<long long> perFirstTile = dlx.startCounts();
+        SolutionBuffer buffer(sink);
+        long long total = dlx.forEachSolution([&perFirstTile, &buffer](const DancingLinks& d) {
+            ++perFirstTile[d.startTile()];
+            if (buffer.enabled()) {
+                buffer.add(d.getBoard());
+            }
+        });
+        buffer.flush();
+        if (sink) {
+            sink->close();
+        }
+        std::cout << "Solutions : " << total << std::endl;
+        displaySubtreeCounts(tiles, perFirstTile);
+    } else if (dlx.solve()) {
+        std::cout << "Solution found:" << std::endl;
+        dlx.getBoard().display();
+    } else {
+        std::cout << "No solution found." << std::endl;
     }
-
-    file.close();
+    nodes = dlx.getNodes();
 }
 
-bool solve(MacMahonBoard& board, int row, int col, std::vector<MacMahonTile>& tiles) {
-
-    // Si nous arrivons à la fin du tableau, nous avons terminé
-    if(row == ROWS) {
-        // Nous avons atteint la fin du tableau
-        return true; // Toutes les tuiles ont été placées avec succès
-    }
-
-
-
-    for(int i = 0; i < tiles.size(); i++) {
-        if(canPlaceTile(board, row, col, tiles[i])) {
-            board.placeTile(row, col, tiles[i]);
-
-            // Supprime la tuile des tuiles disponibles
-            MacMahonTile usedTile = tiles[i];
-            tiles.erase(tiles.begin() + i);
-            int newRow = (col == COLS - 1 )? row + 1 : row;
-            int newCol =( col == COLS - 1 )? 0 : col + 1;
-
-            // Essayez de manière récursive de résoudre la position suivante
-            if(solve(board, newRow, newCol, tiles)) {
-                return true;
+// --join : lignes du haut parcourues tuile de départ par tuile de départ,
+// partie du bas jointe à l'avance. Affiche la taille des tables.
+static void runRowJoin(const SolverOptions& options, const std::vector<MacMahonTile>& tiles,
+                       const CompatibilityIndex& index, const SymmetryBreaker& symmetry, long long& nodes) {
+    RowTables tables(ROWS, COLS, tiles, index);
+    for (int task = 0; task < tables.enumerationTasks(); ++task) {
+        tables.enumerate(task);
+    }
+    tables.build();
+    RowJoinSearch search(tables);
+    if (options.count) {
+        std::vector<long long> perFirstTile(tiles.size(), -1);
+        long long total = 0;
+        for (int i = 0; i < int(tiles.size()); i++) {
+            if (symmetry.isCanonicalStart(i)) {
+                perFirstTile[i] = search.countFrom(i);
             }
-
-            // Si nous sommes arrivés ici, le placement était erroné. annuler.
-            tiles.insert(tiles.begin() + i, usedTile);
-            board.placeTile(row, col, MacMahonTile());  // Ajoutez cette ligne pour supprimer la tuile placée.
+        }
+        symmetry.completeSubtreeCounts(perFirstTile);
+        for (long long c : perFirstTile) {
+            total += c > 0 ? c : 0;
+        }
+        std::cout << "Solutions : " << total << std::endl;
+        displaySubtreeCounts(tiles, perFirstTile);
+    } else {
+        bool found = false;
+        for (int i = 0; i < int(tiles.size()) && !found; i++) {
+            found = symmetry.isCanonicalStart(i) && search.solveFrom(i);
+        }
+        if (found) {
+            std::cout << "Solution found:" << std::endl;
+            search.getBoard().display();
+        } else {
+            std::cout << "No solution found." << std::endl;
         }
     }
-    return false; // Impossible de placer une tuile à la position actuelle
+    nodes = search.getNodes();
+    std::cout << "Demi-lignes : " << tables.leftHalves() << " à gauche, " << tables.rightHalves()
+              << " à droite ; partie du bas : " << ROWS - tables.splitRow() << " lignes, "
+              << tables.bottomStates() << " états" << std::endl;
 }
 
-
 int main(int argc, char* argv[]) {
-    if(argc != 2) { // On s'assure d'avoir le bon nombre d'arguments : le nom du programme, le nom du fichier, ROWS et COLS
-        std::cerr << "Usage: " << argv[0] << " <filename>" << std::endl;
+    SolverOptions options;
+    if(!parseOptions(argc, argv, options, false)) { // On s'assure d'avoir les bons arguments : le nom du fichier et les options
+        std::cerr << "Usage: " << argv[0] << " [--count [--output <fichier|-> [--format text|csv|bin]]] [--no-symmetry] [--order row|spiral|mrv] [--forward-check] [--generic] [--progress MS] [--memo MO] [--rotations] [--dlx] [--join] <filename>" << std::endl;
         return 1; // quitte avec une erreur
     }
 
-    std::string filename = argv[1];
+    std::string filename = options.filename;
 
     std::vector<MacMahonTile> tiles;
 
-    readDataFromFile(filename, tiles);
-    MacMahonBoard board;
-
+    // Le chargement est mesuré à part du temps de résolution
+    auto loadStart = std::chrono::steady_clock::now();
+    std::vector<int> pieces;
+    LoadResult loaded = loadPuzzle(filename, ROWS, COLS, tiles, options.rotations);
+    if (loaded.ok() && options.rotations) {
+        // --rotations : les moteurs travaillent sur les orientations des tuiles
+        loaded = orientPuzzle(tiles, pieces);
+    }
+    std::chrono::duration<double> loadTime = std::chrono::steady_clock::now() - loadStart;
+    if (!loaded.ok()) {
+        std::cerr << describeLoadError(filename, loaded) << std::endl;
+        return 1;
+    }
+    if (options.join && COLS > RowTables::MAX_COLS) {
+        std::cerr << "--join : " << RowTables::MAX_COLS << " colonnes au plus" << std::endl;
+        return 1;
+    }
+    CompatibilityIndex index(tiles, pieces);
+    // Une seule tuile de départ par classe de symétrie du jeu
+    SymmetryBreaker symmetry(ROWS, COLS, tiles, options.colorSymmetry());
+
+    // --output : les solutions énumérées sont écrites par le thread du sink
+    std::unique_ptr<SolutionSink> sink;
+    if (!options.output.empty()) {
+        sink.reset(new SolutionSink(ROWS, COLS, options.format));
+        if (!sink->open(options.output)) {
+            std::cerr << "Impossible d'écrire " << options.output << std::endl;
+            return 1;
+        }
+    }
 
-    //calcul du temps
-    clock_t start, end;
-    start = clock();
-    if (solve(board, 0, 0, tiles)) {
-        std::cout << "Solution found:" << std::endl;
-        board.display();
+    // Temps réel et temps CPU de la recherche seule
+    Stopwatch watch;
+    // --progress : rapport périodique sur la sortie d'erreur
+    ProgressMonitor monitor(1, options.progress);
+    monitor.start();
+    // --memo : états sans issue partagés entre les sous-arbres des tuiles de départ
+    std::unique_ptr<DeadStateTable> memo;
+    if (options.memo > 0) {
+        memo.reset(new DeadStateTable(options.memo));
+    }
+    long long nodes = 0;
+    bool fixed = false;
+    if (options.dlx) {
+        runDancingLinks(options, tiles, index, sink.get(), nodes);
+    } else if (options.join) {
+        runRowJoin(options, tiles, index, symmetry, nodes);
+    } else if (options.fixedSize) {
+        fixed = dispatchBoardSize<SequentialSolver>(ROWS, COLS, options, tiles, index, symmetry, sink.get(), monitor,
+                                                    memo.get(), nodes);
     } else {
-        std::cout << "No solution found." << std::endl;
+        SequentialSolver<0, 0>::run(options, tiles, index, symmetry, sink.get(), monitor, memo.get(), nodes);
+    }
+    monitor.stop();
+    double wall = watch.wallSeconds(), cpu = watch.cpuSeconds();
+    displaySearchStats(wall, cpu, nodes);
+    std::cout << "Temps de chargement : " << loadTime.count() * 1000 << " ms" << std::endl;
+    std::cout << "Symétries du jeu : " << symmetry.getSymmetries().size()
+              << ", types de tuiles : " << tileTypes(tiles).size() << std::endl;
+    if (options.rotations) {
+        std::cout << "Rotations : " << tiles.size() << " orientations pour " << ROWS * COLS << " tuiles" << std::endl;
+    }
+    if (options.dlx) {
+        std::cout << "Moteur : couverture exacte (dlx)" << std::endl;
+    } else if (options.join) {
+        std::cout << "Moteur : jointure de lignes" << std::endl;
+    } else {
+        std::cout << "Ordre des cases : " << cellOrderName(options.order)
+                  << (options.forwardCheck ? ", vérification en avant" : "") << std::endl;
+        std::cout << "Moteur : " << (fixed ? "spécialisé " + std::to_string(ROWS) + "x" + std::to_string(COLS) : std::string("générique")) << std::endl;
+    }
+    if (sink) {
+        std::cout << "Solutions écrites : " << sink->getSolutions() << std::endl;
+    }
+    if (memo) {
+        memo->display();
     }
-    //calcul de fin de temps
-    end = clock();
-    double time_taken = double(end - start) / double(CLOCKS_PER_SEC);
-    std::cout << "Time taken by program is : " << std::fixed << time_taken << " sec " << std::endl;
 
+    printSearchStats();
     return 0;
-}
\ No newline at end of file
+}
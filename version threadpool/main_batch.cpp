@@ -0,0 +1,371 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+
+#include "../commun/macmahon.h"
+#include "../commun/index.h"
+#include "../commun/loader.h"
+#include "../commun/search.h"
+#include "../commun/options.h"
+#include "../commun/symmetry.h"
+#include "../commun/threadpool.h"
+#include "../commun/batch.h"
+#include "../commun/container.h"
+
+// Résolution d'une série de plateaux sur un seul ThreadPool, créé une fois
+// pour toute la série. Deux découpages :
+//   --mode puzzle : une tâche par plateau, résolu en séquentiel (beaucoup de
+//                   petits plateaux) ;
+//   --mode tile   : une tâche par tuile de départ, comme main_threadpool
+//                   (peu de gros plateaux).
+// Dans les deux cas, plusieurs plateaux sont en cours à la fois et chaque
+// résultat est affiché dès que le plateau est terminé. La série peut aussi
+// être lue dans un conteneur binaire, et les solutions écrites dans un autre
+// (--solutions, commun/container.h).
+
+enum BatchMode {
+    MODE_PUZZLE,
+    MODE_TILE
+};
+
+typedef std::chrono::steady_clock Clock;
+
+// Un plateau de la série et l'état partagé par ses tâches.
+struct PuzzleJob {
+    int id;
+    uint32_t record;                        // numéro du plateau dans sa source
+    std::string filename;
+    int rows, cols;
+    std::vector<MacMahonTile> tiles;
+    std::unique_ptr<CompatibilityIndex> index;
+    std::unique_ptr<SymmetryBreaker> symmetry;
+    std::vector<int> startingTiles;
+    std::vector<long long> subtreeCounts;   // --count : une case par tuile de départ
+    CancellationToken cancellation;         // annulé à la première solution du plateau
+    std::atomic_bool solutionFound;
+    std::unique_ptr<MacMahonBoard> solution;
+    std::atomic<long long> nodes;
+    std::atomic<long long> busyMicros;      // temps de calcul cumulé des tâches
+    std::atomic<int> pending;               // tâches restantes
+    Clock::time_point submitted;
+
+    PuzzleJob() : id(0), record(0), rows(0), cols(0), solutionFound(false), nodes(0), busyMicros(0), pending(0) {}
+};
+
+class BatchSolver {
+public:
+    BatchSolver(const SolverOptions& options, BatchMode mode, bool showBoards, size_t threads)
+        : options(options), mode(mode), showBoards(showBoards), pool(threads),
+          maxInFlight(2 * pool.size()), inFlight(0), submitted(0), loadSeconds(0),
+          solved(0), unsolved(0), failed(0), totalNodes(0) {}
+
+    // Charge le plateau et met ses tâches en file.
+    void submit(const std::string& filename) {
+        PuzzleJob* job = begin(filename);
+        // Le chargement est compté à part du temps de calcul
+        LoadResult loaded = loadPuzzle(filename, job->rows, job->cols, job->tiles);
+        launch(job, loaded.ok() ? std::string() : describeLoadError(filename, loaded));
+    }
+
+    // Même chose pour le plateau i d'un conteneur binaire.
+    void submit(const std::string& container, const ContainerReader& reader, size_t i) {
+        PuzzleJob* job = begin(container + "#" + std::to_string(i));
+        job->record = uint32_t(i);
+        PuzzleRecord record;
+        LoadResult loaded = reader.puzzle(i, record);
+        if (loaded.ok()) {
+            job->filename = record.name.empty() ? job->filename : record.name;
+            job->rows = record.rows;
+            job->cols = record.cols;
+            job->tiles.swap(record.tiles);
+        }
+        launch(job, loaded.ok() ? std::string() : describeLoadError(job->filename, loaded));
+    }
+
+    // Solutions gardées dans un conteneur écrit par saveSolutions.
+    void keepSolutions() {
+        solutions.reset(new ContainerWriter(CONTAINER_SOLUTIONS));
+    }
+
+    bool saveSolutions(const std::string& filename) const {
+        return solutions->save(filename);
+    }
+
+    void wait() {
+        pool.wait();
+    }
+
+    void report(double seconds) const {
+        int total = solved + unsolved + failed;
+        std::cout << "Plateaux : " << total << " (" << solved << (options.count ? " avec solution, " : " résolus, ")
+                  << unsolved << " sans solution, " << failed << " invalides) en " << seconds << " s, "
+                  << (seconds > 0 ? total / seconds : 0) << " plateaux/s" << std::endl;
+        std::cout << "Noeuds explorés : " << totalNodes << " (" << (seconds > 0 ? totalNodes / seconds : 0)
+                  << " noeuds/s), " << pool.size() << " threads, mode "
+                  << (mode == MODE_PUZZLE ? "puzzle" : "tile") << std::endl;
+        std::cout << "Chargement : " << loadSeconds << " s au total, "
+                  << (total > 0 ? loadSeconds * 1e6 / total : 0) << " µs par plateau" << std::endl;
+    }
+
+private:
+    // Attend que le nombre de plateaux en cours repasse sous la limite, ce qui
+    // borne la mémoire quelle que soit la taille de la série.
+    PuzzleJob* begin(const std::string& filename) {
+        {
+            std::unique_lock<std::mutex> lock(windowMutex);
+            windowCondition.wait(lock, [this] { return inFlight < maxInFlight; });
+            ++inFlight;
+        }
+        PuzzleJob* job = new PuzzleJob;
+        job->id = ++submitted;
+        job->record = uint32_t(job->id - 1);
+        job->filename = filename;
+        job->submitted = Clock::now();
+        return job;
+    }
+
+    // Prépare l'index et les tuiles de départ du plateau chargé, puis met ses tâches en file.
+    void launch(PuzzleJob* job, const std::string& error) {
+        loadSeconds += std::chrono::duration<double>(Clock::now() - job->submitted).count();
+        if (!error.empty()) {
+            complete(job, error);
+            return;
+        }
+        job->index.reset(new CompatibilityIndex(job->tiles));
+        job->symmetry.reset(new SymmetryBreaker(job->rows, job->cols, job->tiles, options.symmetry));
+        for (int i = 0; i < int(job->tiles.size()); i++) {
+            if (job->symmetry->isCanonicalStart(i)) {
+                job->startingTiles.push_back(i);
+            }
+        }
+        job->subtreeCounts.assign(job->tiles.size(), -1);
+
+        if (mode == MODE_PUZZLE) {
+            job->pending = 1;
+            pool.enqueue([this, job] { solveWhole(job); });
+        } else if (job->startingTiles.empty()) {
+            complete(job, std::string());
+        } else {
+            job->pending = int(job->startingTiles.size());
+            pool.enqueueBulk(int(job->startingTiles.size()), [this, job](int k) { solveFrom(job, k); });
+        }
+    }
+
+    // --mode puzzle : tout le plateau dans une seule tâche
+    void solveWhole(PuzzleJob* job) {
+        Clock::time_point start = Clock::now();
+        SearchEngine engine(job->rows, job->cols, job->tiles, *job->index, options.order);
+        engine.setForwardChecking(options.forwardCheck);
+        if (options.count) {
+            for (int i : job->startingTiles) {
+                engine.reset();
+                if (engine.place(i)) {
+                    job->subtreeCounts[i] = engine.countSolutions();
+                }
+            }
+        } else {
+            SearchTask root;
+            root.length = 0;
+            root.choices = job->symmetry->canonicalStarts();
+            engine.load(root);
+            if (engine.solve()) {
+                job->solutionFound = true;
+                job->solution.reset(new MacMahonBoard(engine.getBoard()));
+            }
+        }
+        job->nodes += engine.getNodes();
+        finishTask(job, start);
+    }
+
+    // --mode tile : le sous-arbre de la k-ième tuile de départ
+    void solveFrom(PuzzleJob* job, int k) {
+        Clock::time_point start = Clock::now();
+        int tile = job->startingTiles[k];
+        if (!job->cancellation.isCancelled()) {
+            SearchEngine engine(job->rows, job->cols, job->tiles, *job->index, options.order);
+            engine.setCheckInterval(options.checkInterval);
+            engine.setForwardChecking(options.forwardCheck);
+            if (engine.place(tile)) {
+                if (options.count) {
+                    job->subtreeCounts[tile] = engine.countSolutions();
+                } else if (engine.solve(&job->cancellation) && !job->solutionFound.exchange(true)) {
+                    // Les autres tâches du plateau s'arrêtent à leur prochaine vérification
+                    job->cancellation.cancel();
+                    job->solution.reset(new MacMahonBoard(engine.getBoard()));
+                }
+                job->nodes += engine.getNodes() + 1;
+            }
+        }
+        finishTask(job, start);
+    }
+
+    void finishTask(PuzzleJob* job, Clock::time_point start) {
+        job->busyMicros += std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+        if (job->pending.fetch_sub(1) == 1) {
+            complete(job, std::string());
+        }
+    }
+
+    // Affiche le résultat du plateau dès sa dernière tâche terminée, puis le libère.
+    void complete(PuzzleJob* job, const std::string& error) {
+        {
+            std::lock_guard<std::mutex> lock(outputMutex);
+            std::cout << "[" << job->id << "] ";
+            if (!error.empty()) {
+                std::cout << error << std::endl;
+                ++failed;
+            } else {
+                std::cout << job->filename << " (" << job->rows << "x" << job->cols << ") : ";
+                bool found = job->solutionFound;
+                long long total = found ? 1 : 0;
+                if (options.count) {
+                    job->symmetry->completeSubtreeCounts(job->subtreeCounts);
+                    total = 0;
+                    for (long long c : job->subtreeCounts) {
+                        total += c > 0 ? c : 0;
+                    }
+                    found = total > 0;
+                    std::cout << total << " solutions";
+                } else {
+                    std::cout << (found ? "solution trouvée" : "aucune solution");
+                }
+                std::chrono::duration<double> latency = Clock::now() - job->submitted;
+                std::cout << ", " << job->nodes << " noeuds, calcul " << job->busyMicros / 1e6 << " s, terminé en "
+                          << latency.count() << " s" << std::endl;
+                if (showBoards && job->solution) {
+                    job->solution->display();
+                }
+                if (solutions) {
+                    SolutionRecord record = {job->record, uint64_t(total), job->rows, job->cols,
+                                             std::vector<MacMahonTile>()};
+                    for (int cell = 0; job->solution && cell < job->rows * job->cols; ++cell) {
+                        record.board.push_back(job->solution->getTileAt(cell / job->cols, cell % job->cols));
+                    }
+                    solutions->addSolution(record);
+                }
+                if (found) {
+                    ++solved;
+                } else {
+                    ++unsolved;
+                }
+                totalNodes += job->nodes;
+            }
+        }
+        delete job;
+        {
+            std::lock_guard<std::mutex> lock(windowMutex);
+            --inFlight;
+        }
+        windowCondition.notify_one();
+    }
+
+    SolverOptions options;
+    BatchMode mode;
+    bool showBoards;
+    ThreadPool pool;
+    const size_t maxInFlight;
+
+    std::mutex windowMutex;
+    std::condition_variable windowCondition;
+    size_t inFlight;
+    int submitted;
+    double loadSeconds;     // chargement des fichiers, fait par le thread principal
+
+    // Compteurs de la série et solutions gardées, modifiés sous outputMutex
+    std::mutex outputMutex;
+    int solved, unsolved, failed;
+    long long totalNodes;
+    std::unique_ptr<ContainerWriter> solutions;
+};
+
+int main(int argc, char* argv[]) {
+    // Options propres à la série, le reste est lu par parseOptions
+    BatchMode mode = MODE_PUZZLE;
+    bool showBoards = false;
+    std::string solutionsFile;
+    bool valid = true;
+    std::vector<char*> rest(1, argv[0]);
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--mode") == 0 && i + 1 < argc) {
+            std::string m = argv[++i];
+            if (m == "puzzle") {
+                mode = MODE_PUZZLE;
+            } else if (m == "tile") {
+                mode = MODE_TILE;
+            } else {
+                valid = false;
+            }
+        } else if (std::strcmp(argv[i], "--solutions") == 0 && i + 1 < argc) {
+            solutionsFile = argv[++i];
+        } else if (std::strcmp(argv[i], "--boards") == 0) {
+            showBoards = true;
+        } else {
+            rest.push_back(argv[i]);
+        }
+    }
+    SolverOptions options;
+    // Les solutions d'une série vont dans le conteneur de --solutions ; le
+    // suivi de progression, la table des états sans issue, les rotations et les
+    // moteurs --dlx et --join ne portent que sur la recherche d'un seul plateau
+    if (!valid || !parseOptions(int(rest.size()), rest.data(), options, true) || !options.output.empty() ||
+        options.progress > 0 || options.memo > 0 || options.rotations || options.dlx ||
+        options.join) {
+        std::cerr << "Usage: " << argv[0] << " [--mode puzzle|tile] [--boards] [--solutions <fichier>] [--count] [--no-symmetry]"
+                  << " [--order row|spiral|mrv] [--forward-check] [--check-interval N]"
+                  << " <répertoire|manifeste|conteneur|-> [threads]" << std::endl;
+        return 1;
+    }
+
+    // Conteneur binaire de plateaux, ou liste de fichiers texte
+    bool binary = ContainerReader::isContainer(options.filename);
+    ContainerReader reader;
+    PuzzleSource source;
+    if (binary) {
+        LoadResult opened = reader.open(options.filename);
+        if (!opened.ok() || reader.kind() != CONTAINER_PUZZLES) {
+            std::cerr << (opened.ok() ? options.filename + " : conteneur de solutions"
+                                      : describeLoadError(options.filename, opened)) << std::endl;
+            return 1;
+        }
+    } else if (!source.open(options.filename)) {
+        std::cerr << "Impossible d'ouvrir " << options.filename << std::endl;
+        return 1;
+    }
+
+    size_t threads = options.threads > 0 ? size_t(options.threads) : std::thread::hardware_concurrency();
+    auto start = Clock::now();
+    // Le pool est détruit avant l'affichage de l'instrumentation, qui ne
+    // compte le temps de ses workers qu'à leur sortie
+    {
+        BatchSolver batch(options, mode, showBoards, threads);
+        if (!solutionsFile.empty()) {
+            batch.keepSolutions();
+        }
+        if (binary) {
+            for (size_t i = 0; i < reader.size(); ++i) {
+                batch.submit(options.filename, reader, i);
+            }
+        } else {
+            std::string filename;
+            while (source.next(filename)) {
+                batch.submit(filename);
+            }
+        }
+        batch.wait();
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+        batch.report(elapsed.count());
+        if (!solutionsFile.empty() && !batch.saveSolutions(solutionsFile)) {
+            std::cerr << "Impossible d'écrire " << solutionsFile << std::endl;
+            return 1;
+        }
+    }
+    printSearchStats();
+    return 0;
+}
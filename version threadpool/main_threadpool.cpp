@@ -1,312 +1,302 @@
 #include <iostream>
-#include <fstream>
 #include <vector>
 #include <thread>       // For std::thread
-#include <mutex>        // For std::mutex
 #include <atomic>       // For std::atomic_bool
-#include <condition_variable>
-#include <queue>
-#include <functional>
-#include <future>
+#include <chrono>
+#include <memory>
+#include <mutex>
+
+#include "../commun/macmahon.h"
+#include "../commun/index.h"
+#include "../commun/loader.h"
+#include "../commun/search.h"
+#include "../commun/options.h"
+#include "../commun/symmetry.h"
+#include "../commun/sink.h"
+#include "../commun/timing.h"
+#include "../commun/progress.h"
+#include "../commun/memo.h"
+#include "../commun/dlx.h"
+#include "../commun/rowjoin.h"
+#include "../commun/threadpool.h"
+
+int ROWS = 0;
+int COLS = 0;
+
+std::atomic_bool solutionFound(false);  // This will be set to true if a solution is found
+std::atomic<long long> totalNodes(0);   // Somme des noeuds explorés par toutes les tâches
+CancellationToken cancellation;         // Annulé dès la première solution
+int checkInterval = SearchEngine::DEFAULT_CHECK_INTERVAL;
+bool countMode = false;                 // --count : toutes les solutions, par tuile de départ
+CellOrder cellOrder = ORDER_ROW_MAJOR;  // --order : ordre de remplissage des cases
+bool forwardCheck = false;              // --forward-check : vérification en avant
+std::vector<long long> subtreeCounts;   // Une case par tâche, fusionnées à la fin
+SolutionSink* sink = 0;                 // --output : solutions écrites, 0 sinon
+ProgressMonitor* monitor = 0;           // --progress : une case par tuile de départ, 0 sinon
+double startShare = 0;                  // part de l'arbre sous chaque tuile de départ
+DeadStateTable* memo = 0;               // --memo : états sans issue partagés, 0 sinon
+std::mutex countMutex;                  // --dlx : fusion des comptes des tâches
 
 
-class ThreadPool {
-public:
-    ThreadPool(size_t threads) : stop(false) {
-        for(size_t i = 0; i < threads; ++i)
-            workers.emplace_back(
-                [this] {
-                    for(;;) {
-                        std::function<void()> task;
-                        {
-                            std::unique_lock<std::mutex> lock(this->queue_mutex);
-                            this->condition.wait(lock,
-                                [this] { return this->stop || !this->tasks.empty(); });
-                            if(this->stop && this->tasks.empty())
-                                return;
-                            task = std::move(this->tasks.front());
-                            this->tasks.pop();
-                        }
-                        task();
-                    }
-                }
-            );
-    }
 
-    template<class F, class... Args>
-    auto enqueue(F&& f, Args&&... args) 
-        -> std::future<typename std::result_of<F(Args...)>::type> {
-        using return_type = typename std::result_of<F(Args...)>::type;
-        auto task = std::make_shared< std::packaged_task<return_type()> >(
-            std::bind(std::forward<F>(f), std::forward<Args>(args)...)
-        );        
-        std::future<return_type> res = task->get_future();
-        {
-            std::unique_lock<std::mutex> lock(queue_mutex);
-            if(stop)
-                throw std::runtime_error("enqueue on stopped ThreadPool");
-            tasks.emplace([task](){ (*task)(); });
-        }
-        condition.notify_one();
-        return res;
-    }
 
-    ~ThreadPool() {
-        {
-            std::unique_lock<std::mutex> lock(queue_mutex);
-            stop = true;
+void solveWithThread(const std::vector<MacMahonTile>& tiles, const CompatibilityIndex& index, int startingTileIndex) {
+    if (cancellation.isCancelled()) {
+        return; // Sortez plus tôt si une solution a déjà été trouvée
+    }
+    // Chaque thread a son propre moteur : plateau, pile et tuiles restantes locaux
+    SearchEngine engine(ROWS, COLS, tiles, index, cellOrder);
+    engine.setCheckInterval(checkInterval);
+    engine.setForwardChecking(forwardCheck);
+    engine.setDeadStateTable(memo);
+    ProgressSlot* progress = monitor ? &monitor->slot(startingTileIndex) : 0;
+    // Placez la tuile initiale sur le plateau, si elle respecte la contrainte du coin
+    if (!engine.place(startingTileIndex)) {
+        if (progress) {
+            progress->finish(startShare);
         }
-        condition.notify_all();
-        for(std::thread &worker: workers)
-            worker.join();
+        return;
     }
-
-private:
-    std::vector< std::thread > workers;
-    std::queue< std::function<void()> > tasks;
-    
-    std::mutex queue_mutex;
-    std::condition_variable condition;
-    bool stop;
-};
-int ROWS;
-int COLS;
-clock_t start, end;
-enum TileColor {
-    EMPTY,
-    BLUE,
-    GREEN,
-    RED
-};
-
-class MacMahonTile {
-public:
-    MacMahonTile() : colors{EMPTY, EMPTY, EMPTY, EMPTY} {}
-
-    void setColors(TileColor top, TileColor right, TileColor bottom, TileColor left) {
-        colors[0] = top;
-        colors[1] = right;
-        colors[2] = bottom;
-        colors[3] = left;
+    engine.setProgress(progress, startShare);
+
+    if (countMode) {
+        // Chaque tâche compte dans ses propres variables, sans atomique partagé,
+        // et formate ses solutions dans son propre tampon
+        SolutionBuffer buffer(sink);
+        subtreeCounts[startingTileIndex] = engine.forEachSolution([&buffer](const SearchEngine& e) {
+            if (buffer.enabled()) {
+                buffer.add(e.getBoard());
+            }
+        });
+        totalNodes += engine.getNodes() + 1;
+        return;
     }
 
-    TileColor getColorAt(int position) const {
-        return colors[position];
+    // Exécutez la recherche séquentielle sous cette tuile de départ
+    bool found = engine.solve(&cancellation);
+    totalNodes += engine.getNodes() + 1;
+    if (found && !solutionFound.exchange(true)) {
+        // Les autres tâches s'arrêtent à leur prochaine vérification ; une
+        // seule arrive ici, l'affichage se passe donc de verrou
+        cancellation.cancel();
+        engine.getBoard().display();
     }
-
-private:
-    TileColor colors[4];
-};
-
-class MacMahonBoard {
-public:
-    MacMahonBoard(int rows, int cols) : ROWS(rows), COLS(cols), board(rows, std::vector<MacMahonTile>(cols)) {}
-
-    void placeTile(int row, int col, const MacMahonTile &tile) {
-        board[row][col] = tile;
+}
+// --dlx : une tâche par option de la première case couverte, chacune avec
+// sa propre matrice
+void solveWithDancingLinks(const std::vector<MacMahonTile>& tiles, const CompatibilityIndex& index, int option) {
+    if (cancellation.isCancelled()) {
+        return;
     }
-
-    const MacMahonTile& getTileAt(int row, int col) const {
-        return board[row][col];
+    DancingLinks dlx(ROWS, COLS, tiles, index);
+    dlx.setCheckInterval(checkInterval);
+    if (!dlx.place(option)) {
+        return;
     }
 
-    void display() const {
-        for (int i = 0; i < ROWS; ++i) {
-            for (int j = 0; j < COLS; ++j) {
-                for (int k = 0; k < 4; ++k) {
-                    switch (board[i][j].getColorAt(k)) {
-                        case RED:
-                            std::cout << "R";
-                            break;
-                        case GREEN:
-                            std::cout << "G";
-                            break;
-                        case BLUE:
-                            std::cout << "B";
-                            break;
-                        default:
-                            std::cout << " ";
-                            break;
-                    }
-                }
-                std::cout << "\t";
+    if (countMode) {
+        // Plusieurs tâches peuvent avoir la même tuile en (0,0) : comptes
+        // locaux, fusionnés une fois la tâche terminée
+        std::vector<long long> counts(tiles.size(), 0);
+        SolutionBuffer buffer(sink);
+        dlx.forEachSolution([&counts, &buffer](const DancingLinks& d) {
+            ++counts[d.startTile()];
+            if (buffer.enabled()) {
+                buffer.add(d.getBoard());
             }
-            std::cout << std::endl;
+        });
+        totalNodes += dlx.getNodes() + 1;
+        std::lock_guard<std::mutex> lock(countMutex);
+        for (size_t i = 0; i < counts.size(); ++i) {
+            subtreeCounts[i] += counts[i];
         }
+        return;
     }
 
-private:
-    const int ROWS, COLS;
-    std::vector<std::vector<MacMahonTile>> board;
-};
-
-bool canPlaceTile(MacMahonBoard& board, int row, int col, const MacMahonTile& tile) {
-    // Vérifiez le côté supérieur
-    if(row > 0 && board.getTileAt(row - 1, col).getColorAt(3) != tile.getColorAt(1)) {
-        return false;
-    }
-    // Vérifiez le côté gauche
-    if(col > 0 && board.getTileAt(row, col - 1).getColorAt(2) != tile.getColorAt(0)) {
-        return false;
-    }
-    // Vérifiez le côté gauche du panneau supérieur
-    if(col > 0 && row ==0 && tile.getColorAt(1) != board.getTileAt(row, col - 1).getColorAt(1)) {
-        return false;
-    }
-    // Vérifiez le côté supérieur du tableau de gauche
-    if(row > 0 && col ==0 && tile.getColorAt(0) != board.getTileAt(row - 1, col).getColorAt(0)) {
-        return false;
-    }
-    // Vérifiez le côté droit du panneau supérieur
-    if(col == COLS - 1 && row > 0 && tile.getColorAt(2) != board.getTileAt(row - 1, col).getColorAt(2)) {
-        return false;
+    bool found = dlx.solve(&cancellation);
+    totalNodes += dlx.getNodes() + 1;
+    if (found && !solutionFound.exchange(true)) {
+        cancellation.cancel();
+        dlx.getBoard().display();
     }
-    // Vérifiez le côté gauche du panneau inférieur
-    if(col > 0 && row == ROWS - 1 && tile.getColorAt(3) != board.getTileAt(row, col - 1).getColorAt(3)) {
-        return false;
-    }
-    //vérifiez le côté gauche et supérieur de la première tuile
-    if (row == 0 && col == 0 && tile.getColorAt(0) != tile.getColorAt(1)) {
-        return false;
-    }
-
-    return true;
 }
-
-
-
-TileColor charToTileColor(char c) {
-    switch (c) {
-        case 'R':
-            return RED;
-        case 'G':
-            return GREEN;
-        case 'B':
-            return BLUE;
-        default:
-            return EMPTY;
+// --join : une tâche par tuile de départ, sur les tables de lignes partagées
+void solveWithRowJoin(const RowTables& tables, int startingTileIndex) {
+    if (cancellation.isCancelled()) {
+        return;
     }
-}
-
-void readDataFromFile(const std::string& filename, std::vector<MacMahonTile>& tiles) {
-    std::ifstream file(filename);
-    if (!file) {
-        std::cerr << "Impossible d'ouvrir le fichier." << std::endl;
+    RowJoinSearch search(tables);
+    search.setCheckInterval(checkInterval);
+    if (countMode) {
+        subtreeCounts[startingTileIndex] = search.countFrom(startingTileIndex);
+        totalNodes += search.getNodes();
         return;
     }
-
-    file >> ROWS >> COLS;
-    tiles.clear(); // Efface les tuiles avant de les remplir à nouveau.
-
-    for (int i = 0; i <= ROWS * COLS; ++i) {
-        char top, right, bottom, left;
-        file >> left >> top >> right >> bottom;
-        MacMahonTile tile;
-        tile.setColors(charToTileColor(left), charToTileColor(top), charToTileColor(right), charToTileColor(bottom));
-        tiles.push_back(tile);
+    bool found = search.solveFrom(startingTileIndex, &cancellation);
+    totalNodes += search.getNodes();
+    if (found && !solutionFound.exchange(true)) {
+        cancellation.cancel();
+        search.getBoard().display();
     }
-
-    file.close();
 }
+// Main fonction
+int main(int argc, char* argv[]) {
+    SolverOptions options;
+    if(!parseOptions(argc, argv, options, false)) {
+        std::cerr << "Usage: " << argv[0] << " [--count [--output <fichier|-> [--format text|csv|bin]]] [--no-symmetry] [--order row|spiral|mrv] [--forward-check] [--check-interval N] [--progress MS] [--memo MO] [--rotations] [--dlx] [--join] <filename>" << std::endl;
+        return 1;
+    }
 
-std::atomic_bool solutionFound(false);  // This will be set to true if a solution is found
-std::mutex mtx;                         // Mutex to synchronize access to shared resources
+    std::string filename = options.filename;
+    checkInterval = options.checkInterval;
+    countMode = options.count;
+    cellOrder = options.order;
+    forwardCheck = options.forwardCheck;
 
-bool solve(MacMahonBoard& board, int row, int col, std::vector<MacMahonTile>& tiles) {
-    // Vérifiez si une solution a déjà été trouvée
-    if (solutionFound.load()) {
-        return false;
+    std::vector<MacMahonTile> tiles;
+    std::vector<int> pieces;
+    LoadResult loaded = loadPuzzle(filename, ROWS, COLS, tiles, options.rotations);
+    if (loaded.ok() && options.rotations) {
+        // --rotations : les moteurs travaillent sur les orientations des tuiles
+        loaded = orientPuzzle(tiles, pieces);
     }
-    // Si nous arrivons à la fin du tableau, nous avons terminé
-    if(row == ROWS) {
-        // Nous avons atteint la fin du tableau
-        return true; // Toutes les tuiles ont été placées avec succès
+    if (!loaded.ok()) {
+        std::cerr << describeLoadError(filename, loaded) << std::endl;
+        return 1;
     }
 
-
-
-    for(int i = 0; i < tiles.size(); i++) {
-        if(canPlaceTile(board, row, col, tiles[i])) {
-            board.placeTile(row, col, tiles[i]);
-
-            // Supprime la tuile des tuiles disponibles
-            MacMahonTile usedTile = tiles[i];
-            tiles.erase(tiles.begin() + i);
-            int newRow = (col == COLS - 1 )? row + 1 : row;
-            int newCol =( col == COLS - 1 )? 0 : col + 1;
-
-            // Essayez de manière récursive de résoudre la position suivante
-            if(solve(board, newRow, newCol, tiles)) {
-                return true;
-            }
-
-            // Si nous sommes arrivés ici, le placement était erroné. annuler.
-            tiles.insert(tiles.begin() + i, usedTile);
-            board.placeTile(row, col, MacMahonTile());  // Ajoutez cette ligne pour supprimer la tuile placée.
+    if (options.join && COLS > RowTables::MAX_COLS) {
+        std::cerr << "--join : " << RowTables::MAX_COLS << " colonnes au plus" << std::endl;
+        return 1;
+    }
+    CompatibilityIndex index(tiles, pieces);
+    subtreeCounts.assign(tiles.size(), -1);
+
+    // Une seule tuile de départ par classe de symétrie du jeu
+    SymmetryBreaker symmetry(ROWS, COLS, tiles, options.colorSymmetry());
+    std::vector<int> startingTiles;
+    for (int i = 0; i < int(tiles.size()); i++) {
+        if (symmetry.isCanonicalStart(i)) {
+            startingTiles.push_back(i);
         }
     }
-    return false; // Impossible de placer une tuile à la position actuelle
-}
-
 
-
-void solveWithThread(MacMahonBoard initialBoard, std::vector<MacMahonTile> initialTiles, int startingTileIndex) {
-    if (solutionFound.load()) {
-        return; // Sortez plus tôt si une solution a déjà été trouvée
+    // --dlx : le travail est découpé selon les options de la première case
+    // couverte, et les comptes par tuile de départ sont complets
+    std::vector<int> firstChoices;
+    if (options.dlx) {
+        DancingLinks root(ROWS, COLS, tiles, index);
+        firstChoices = root.firstChoices();
+        subtreeCounts = root.startCounts();
     }
-    // Utilisez une copie locale du plateau et des tuiles pour chaque thread
-    MacMahonBoard board = initialBoard;
-    std::vector<MacMahonTile> tiles = initialTiles;      // Copie locale des tuiles
-    // Placez la tuile initiale sur le plateau
-    board.placeTile(0, 0, tiles[startingTileIndex]);
-    tiles.erase(tiles.begin() + startingTileIndex);
 
-    // Exécutez la fonction séquentielle ici
-    if (solve(board, 0, 0, tiles) && !solutionFound.exchange(true)) {
-        std::lock_guard<std::mutex> lock(mtx);
-        board.display();
-    }
-}
-// Main fonction
-int main(int argc, char* argv[]) {
-    if(argc != 2) {
-        std::cerr << "Usage: " << argv[0] << " <filename>" << std::endl;
-        return 1;
+    // --join : tables de demi-lignes, remplies par le pool
+    std::unique_ptr<RowTables> rowTables;
+    if (options.join) {
+        rowTables.reset(new RowTables(ROWS, COLS, tiles, index));
     }
 
-    std::string filename = argv[1];
-
-    std::vector<MacMahonTile> tiles;
-    readDataFromFile(filename, tiles);
-
-    MacMahonBoard board(ROWS, COLS);
-
-    auto start = std::chrono::high_resolution_clock::now();
-
-    ThreadPool pool(std::thread::hardware_concurrency()); // Crée un pool avec le nombre de threads supportés par le matériel
+    // --output : les solutions énumérées sont écrites par le thread du sink
+    SolutionSink solutionSink(ROWS, COLS, options.format);
+    if (!options.output.empty()) {
+        if (!solutionSink.open(options.output)) {
+            std::cerr << "Impossible d'écrire " << options.output << std::endl;
+            return 1;
+        }
+        sink = &solutionSink;
+    }
 
+    // --memo : table partagée sans verrou par toutes les tâches
+    std::unique_ptr<DeadStateTable> memoTable;
+    if (options.memo > 0) {
+        memoTable.reset(new DeadStateTable(options.memo));
+        memo = memoTable.get();
+    }
 
-    std::vector<std::future<bool>> futures;
-    for (int i = 0; i < tiles.size()-1; i++) {
-        futures.emplace_back(pool.enqueue([=] {
-            solveWithThread(board, tiles, i);
-            return true;
-        }));
+    // Temps réel et temps CPU de la recherche seule
+    Stopwatch watch;
+    // --progress : rapport périodique sur la sortie d'erreur
+    ProgressMonitor progressMonitor(int(tiles.size()), options.progress);
+    if (progressMonitor.enabled()) {
+        monitor = &progressMonitor;
+        startShare = 1.0 / startingTiles.size();
+        progressMonitor.start();
     }
-    // Ici, le pool sera automatiquement détruit à la fin de la portée et joindra tous les threads
-    // attendez les futures si vous avez besoin du résultat
-    for (auto &f : futures) {
-        f.wait();
+
+    {
+        ThreadPool pool(std::thread::hardware_concurrency()); // Crée un pool avec le nombre de threads supportés par le matériel
+
+        // Une tâche par tuile de départ, ajoutées en une seule fois ; une fois
+        // le jeton annulé, celles encore en file sont jetées sans être exécutées
+        if (options.dlx) {
+            pool.enqueueBulk(int(firstChoices.size()), [&tiles, &index, &firstChoices](int i) {
+                solveWithDancingLinks(tiles, index, firstChoices[i]);
+            }, &cancellation);
+        } else if (options.join) {
+            // Demi-lignes énumérées en parallèle, puis partie du bas jointe par
+            // ce thread avant la recherche des lignes du haut
+            RowTables& tables = *rowTables;
+            pool.enqueueBulk(tables.enumerationTasks(), [&tables](int i) { tables.enumerate(i); });
+            pool.wait();
+            tables.build();
+            pool.enqueueBulk(int(startingTiles.size()), [&tables, &startingTiles](int i) {
+                solveWithRowJoin(tables, startingTiles[i]);
+            }, &cancellation);
+        } else {
+            pool.enqueueBulk(int(startingTiles.size()), [&tiles, &index, &startingTiles](int i) {
+                solveWithThread(tiles, index, startingTiles[i]);
+            }, &cancellation);
+        }
+        pool.wait();
     }
 
-    auto end = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double> elapsed = end - start;
+    progressMonitor.stop();
+    // Toutes les solutions sont écrites avant le résumé
+    solutionSink.close();
+    double wall = watch.wallSeconds(), cpu = watch.cpuSeconds();
 
-    if (solutionFound) {
+    if (countMode) {
+        if (!options.dlx) {
+            symmetry.completeSubtreeCounts(subtreeCounts);
+        }
+        long long total = 0;
+        for (long long c : subtreeCounts) {
+            total += c > 0 ? c : 0;
+        }
+        std::cout << "Solutions : " << total << std::endl;
+        if (sink) {
+            std::cout << "Solutions écrites : " << sink->getSolutions() << std::endl;
+        }
+        displaySubtreeCounts(tiles, subtreeCounts);
+    } else if (solutionFound) {
         std::cout << "Solution found." << std::endl;
-        std::cout << "Time taken: " << elapsed.count() << " seconds" << std::endl;
     } else {
         std::cout << "No solution found." << std::endl;
     }
+    displaySearchStats(wall, cpu, totalNodes);
+    std::cout << "Symétries du jeu : " << symmetry.getSymmetries().size()
+              << ", types de tuiles : " << tileTypes(tiles).size()
+              << ", tuiles de départ : " << startingTiles.size() << std::endl;
+    if (options.rotations) {
+        std::cout << "Rotations : " << tiles.size() << " orientations pour " << ROWS * COLS << " tuiles" << std::endl;
+    }
+    if (options.dlx) {
+        std::cout << "Moteur : couverture exacte (dlx), " << firstChoices.size() << " tâches" << std::endl;
+    } else if (options.join) {
+        std::cout << "Moteur : jointure de lignes, " << rowTables->leftHalves() << " demi-lignes à gauche, "
+                  << rowTables->rightHalves() << " à droite ; partie du bas : " << ROWS - rowTables->splitRow()
+                  << " lignes, " << rowTables->bottomStates() << " états" << std::endl;
+    } else {
+        std::cout << "Ordre des cases : " << cellOrderName(cellOrder)
+                  << (forwardCheck ? ", vérification en avant" : "") << std::endl;
+    }
+    if (memo) {
+        memo->display();
+    }
+    if (solutionFound) {
+        std::chrono::duration<double> stopping = std::chrono::steady_clock::now() - cancellation.cancelledAt();
+        std::cout << "Délai entre la solution et la sortie : " << stopping.count() * 1000 << " ms" << std::endl;
+    }
+    printSearchStats();
     return 0;
 }
@@ -0,0 +1,115 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <memory>
+
+#include "../commun/macmahon.h"
+#include "../commun/index.h"
+#include "../commun/loader.h"
+#include "../commun/workstealing.h"
+#include "../commun/options.h"
+#include "../commun/symmetry.h"
+#include "../commun/sink.h"
+#include "../commun/timing.h"
+#include "../commun/progress.h"
+#include "../commun/memo.h"
+
+int ROWS = 0;
+int COLS = 0;
+
+int main(int argc, char* argv[]) {
+    SolverOptions options;
+    // Les moteurs de couverture exacte (--dlx) et de jointure de lignes (--join)
+    // ne sont proposés que par les versions séquentielle et ThreadPool
+    if(!parseOptions(argc, argv, options, true) || options.dlx || options.join) {
+        std::cerr << "Usage: " << argv[0] << " [--count [--output <fichier|-> [--format text|csv|bin]]] [--no-symmetry] [--order row|spiral|mrv] [--forward-check] [--check-interval N] [--progress MS] [--memo MO] [--rotations] <filename> [threads]" << std::endl;
+        return 1;
+    }
+
+    std::string filename = options.filename;
+    // Par défaut, autant de workers que de threads supportés par le matériel
+    int threads = options.threads > 0 ? options.threads : int(std::thread::hardware_concurrency());
+
+    std::vector<MacMahonTile> tiles;
+    std::vector<int> pieces;
+    LoadResult loaded = loadPuzzle(filename, ROWS, COLS, tiles, options.rotations);
+    if (loaded.ok() && options.rotations) {
+        // --rotations : les moteurs travaillent sur les orientations des tuiles
+        loaded = orientPuzzle(tiles, pieces);
+    }
+    if (!loaded.ok()) {
+        std::cerr << describeLoadError(filename, loaded) << std::endl;
+        return 1;
+    }
+    CompatibilityIndex index(tiles, pieces);
+    SymmetryBreaker symmetry(ROWS, COLS, tiles, options.colorSymmetry());
+
+    // --output : les solutions énumérées sont écrites par le thread du sink
+    SolutionSink sink(ROWS, COLS, options.format);
+    if (!options.output.empty() && !sink.open(options.output)) {
+        std::cerr << "Impossible d'écrire " << options.output << std::endl;
+        return 1;
+    }
+
+    // Temps réel et temps CPU de la recherche seule
+    Stopwatch watch;
+
+    WorkStealingSolver solver(ROWS, COLS, tiles, index, threads);
+    solver.setCheckInterval(options.checkInterval);
+    solver.setCountMode(options.count);
+    solver.setSymmetryBreaker(&symmetry);
+    solver.setSolutionSink(options.output.empty() ? 0 : &sink);
+    solver.setCellOrder(options.order);
+    solver.setForwardChecking(options.forwardCheck);
+    // --progress : rapport périodique sur la sortie d'erreur, une case par worker
+    ProgressMonitor monitor(threads, options.progress);
+    if (monitor.enabled()) {
+        solver.setProgressMonitor(&monitor);
+        monitor.start();
+    }
+    // --memo : table partagée sans verrou par tous les workers
+    std::unique_ptr<DeadStateTable> memo;
+    if (options.memo > 0) {
+        memo.reset(new DeadStateTable(options.memo));
+        solver.setDeadStateTable(memo.get());
+    }
+    bool found = solver.solve();
+    monitor.stop();
+
+    // Toutes les solutions sont écrites avant le résumé
+    sink.close();
+    double wall = watch.wallSeconds(), cpu = watch.cpuSeconds();
+
+    if (options.count) {
+        std::cout << "Solutions : " << solver.getSolutionCount() << std::endl;
+        if (!options.output.empty()) {
+            std::cout << "Solutions écrites : " << sink.getSolutions() << std::endl;
+        }
+        displaySubtreeCounts(tiles, solver.getSubtreeCounts());
+    } else if (found) {
+        solver.getSolution().display();
+        std::cout << "Solution found." << std::endl;
+    } else {
+        std::cout << "No solution found." << std::endl;
+    }
+    displaySearchStats(wall, cpu, solver.getNodes());
+    std::cout << "Symétries du jeu : " << symmetry.getSymmetries().size()
+              << ", types de tuiles : " << tileTypes(tiles).size() << std::endl;
+    if (options.rotations) {
+        std::cout << "Rotations : " << tiles.size() << " orientations pour " << ROWS * COLS << " tuiles" << std::endl;
+    }
+    std::cout << "Ordre des cases : " << cellOrderName(options.order)
+              << (options.forwardCheck ? ", vérification en avant" : "") << std::endl;
+    if (memo) {
+        memo->display();
+    }
+    std::cout << "Threads: " << threads << ", vols: " << solver.getSteals() << std::endl;
+    if (found && !options.count) {
+        std::chrono::duration<double> stopping = std::chrono::steady_clock::now() - solver.getCancellation().cancelledAt();
+        std::cout << "Délai entre la solution et la sortie : " << stopping.count() * 1000 << " ms" << std::endl;
+    }
+    printSearchStats();
+    return 0;
+}